@@ -50,10 +50,9 @@ Anoptamin::Base::c_HookReturn exitWindowOnEsc(size_t inputVectorSize, uint16_t i
 	const SDL_Event* EventList = static_cast<const SDL_Event*>(inputVector);
 	// Ensure we weren't handed a NULL ptr.
 	check_ptr( EventList != NULL );
-	// This is the return data which all hooked functions, which requires runtime, validity, and output data.
+	// This is the return data which all hooked functions, which requires validity and output data.
 	// However, since we're hooking into the window's event handlers, it doesn't expect data outputs.
 	Anoptamin::Base::c_HookReturn TopTMP;
-	std::clock_t StartTicks = std::clock();
 	TopTMP.Valid = 1;
 	// This is just intended to help visualize that we're running the function whenever the window sees keyboard input!
 	Anoptamin_LogDebug("Running Hooked Function!");
@@ -69,9 +68,7 @@ Anoptamin::Base::c_HookReturn exitWindowOnEsc(size_t inputVectorSize, uint16_t i
 			BobWindow->closeWindow(); break;
 		}
 	}
-	// Cleanup and return to the hook itself.
-	std::clock_t EndTicks = std::clock();
-	TopTMP.ElapsedTicks = EndTicks - StartTicks;
+	// Return to the hook itself; it times us and fills in 'ElapsedTicks' on its own.
 	return TopTMP;
 }
 
@@ -95,13 +92,16 @@ int main() {
 	// Hook the function we setup earlier to the Window's keyboard hook.
 	BobWindow->addHook_KeyboardEvent(exitWindowOnEsc_F);
 	
-	// Start a loop for handling user inputs and general window activity.
+	// Start a loop for handling user inputs and general window activity, for about five seconds.
+	// A background window waits far longer than a frame per call, so the run is bounded by time rather than by a count of calls.
 	bool isclosed = 0;
-	for (uint16_t i = 0; i < 5000; i++) {
-		// This gets all of the SDL_Event objects that have occurred since the last poll, and runs the hooks if any data is attached.
-		std::vector<SDL_Event> Events = BobWindow->fullEventPoll();
-		// Wait one millisecond
-		SDL_Delay(1);
+	const uint64_t Deadline = Anoptamin::Base::clockNanos() + 5000000000ull;
+	while (Anoptamin::Base::clockNanos() < Deadline) {
+		// This sleeps until an event arrives or the next frame (every 16ms) is due, then handles all of the SDL_Event objects
+		// that have occurred since the last poll, and runs the hooks if any data is attached. While the window is minimized
+		// or in the background, it sleeps for longer instead of waking up every frame.
+		// It also returns a view of those events, which points into buffers the window reuses and so is only good until the next poll.
+		BobWindow->waitEvents();
 		if (!BobWindow->isOpen()) {
 			isclosed = 1;
 			break;
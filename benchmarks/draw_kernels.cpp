@@ -0,0 +1,160 @@
+/********!
+ * @file  draw_kernels.cpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Measures the drawing kernels of Anoptamin::Graphics against SDL's
+ *	own SDL_FillRect and SDL_BlitSurface, in megapixels per second,
+ *	drawing to a 1920x1080 window surface under the dummy video driver.
+ * 
+ * @note
+ *	Usage: bench_draw_kernels.out [milliseconds per measurement]
+ *	Every instruction set the CPU supports is measured, and checked
+ *	to draw the same pixels as the scalar kernels.
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+#include "../include/sdl.hpp"
+#include "../include/draw.hpp"
+
+namespace G = Anoptamin::Graphics;
+
+static constexpr int32_t SpriteSize = 256;
+static constexpr uint32_t KeyColor = 0x00FF00FF;
+
+//! Runs 'draw' (which draws 'pixels' pixels) until 'millis' have passed, and returns megapixels per second.
+template <typename FuncT>
+double measure(FuncT draw, uint64_t pixels, uint32_t millis) {
+	draw(); // Warm the caches and page in the surfaces.
+	uint64_t Runs = 0;
+	const uint64_t Start = Anoptamin::Base::clockNanos();
+	uint64_t Elapsed;
+	do {
+		draw();
+		Runs++;
+		Elapsed = Anoptamin::Base::clockNanos() - Start;
+	} while (Elapsed < uint64_t(millis) * 1000000);
+	return double(pixels) * double(Runs) * 1000.0 / double(Elapsed);
+}
+
+//! Fills a sprite with a disc: opaque inside, an antialiased edge, and clear (or the key color) outside.
+void paintSprite(SDL_Surface* sprite, bool keyed) {
+	const G::c_PixelView View = G::c_PixelView::of(sprite);
+	const float Middle = (SpriteSize - 1) / 2.0f, Radius = SpriteSize * 0.45f;
+	for (int32_t y = 0; y < View.Height; y++) {
+		for (int32_t x = 0; x < View.Width; x++) {
+			const float Edge = Radius - std::hypot(x - Middle, y - Middle);
+			const uint32_t Alpha = (Edge >= 1) ? 255 : (Edge <= 0) ? 0 : uint32_t(Edge * 255);
+			const uint32_t Color = (uint32_t(x) << 16) | (uint32_t(y) << 8) | uint32_t((x ^ y) & 255);
+			View.row(y)[x] = keyed ? ((Alpha == 0) ? KeyColor : (Color | 0xFF000000u)) : ((Alpha << 24) | Color);
+		}
+	}
+}
+
+//! Draws 'sprite' over the whole destination, tiled, and returns the pixels drawn.
+template <typename FuncT>
+uint64_t tile(const G::c_PixelView& dst, FuncT drawAt) {
+	for (int32_t y = 0; y < dst.Height; y += SpriteSize) {
+		for (int32_t x = 0; x < dst.Width; x += SpriteSize) drawAt(x, y);
+	}
+	return uint64_t(dst.Width) * uint64_t(dst.Height);
+}
+
+int main(int argc, char** argv) {
+	const uint32_t Millis = (argc > 1) ? uint32_t(std::stoul(argv[1])) : 300;
+	Anoptamin::Log::SetupFiles();
+	Anoptamin::Log::SetLogThreshold(Anoptamin::Log::LOG_WARN);
+	Anoptamin::Base::c_InputReplay::useDummyVideoDriver();
+	assert_libsdl( SDL_Init(SDL_INIT_VIDEO) == 0 );
+	
+	{
+		Anoptamin::Base::c_SDLWindow Window(1920, 1080, "Drawing Kernels", true);
+		SDL_Surface* Target = Window.getRawSDLSurface();
+		SDL_Surface* Sprite = SDL_CreateRGBSurfaceWithFormat(0, SpriteSize, SpriteSize, 32, SDL_PIXELFORMAT_ARGB8888);
+		SDL_Surface* KeyedSprite = SDL_CreateRGBSurfaceWithFormat(0, SpriteSize, SpriteSize, 32, SDL_PIXELFORMAT_ARGB8888);
+		assert_libsdl( Target != NULL && Sprite != NULL && KeyedSprite != NULL );
+		paintSprite(Sprite, false);
+		paintSprite(KeyedSprite, true);
+	
+		const G::c_PixelView Dst = G::c_PixelView::of(Target);
+		const G::c_PixelView Src = G::c_PixelView::of(Sprite), KeyedSrc = G::c_PixelView::of(KeyedSprite);
+		const uint64_t Pixels = uint64_t(Dst.Width) * uint64_t(Dst.Height);
+		std::cout << "Target " << Dst.Width << "x" << Dst.Height << ", " << SDL_GetPixelFormatName(Target->format->format)
+			<< "; best kernels " << G::getDrawISAName(G::getBestDrawISA()) << ". Megapixels per second:\n";
+	
+		// Reference pixels from the scalar kernels, to check the others against.
+		std::vector<uint32_t> Expected[2];
+	
+		const char* Names[4] = {"fill", "opaque blit", "color-keyed blit", "alpha blit"};
+		for (uint8_t Op = 0; Op < 4; Op++) {
+			SDL_SetColorKey(KeyedSprite, (Op == 2) ? SDL_TRUE : SDL_FALSE, KeyColor);
+			SDL_SetSurfaceBlendMode(Sprite, (Op == 3) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+			SDL_Surface* From = (Op == 2) ? KeyedSprite : Sprite;
+			const double SDLRate = measure([&]() {
+				if (Op == 0) {
+					SDL_FillRect(Target, NULL, 0xFF336699);
+					return;
+				}
+				tile(Dst, [&](int32_t x, int32_t y) {
+					SDL_Rect At = {x, y, SpriteSize, SpriteSize};
+					SDL_BlitSurface(From, NULL, Target, &At);
+				});
+			}, Pixels, Millis);
+			std::printf("  %-18s SDL %8.1f", Names[Op], SDLRate);
+	
+			for (uint8_t Isa = 0; Isa <= G::getBestDrawISA(); Isa++) {
+				G::setDrawISA(G::e_Draw_ISA(Isa));
+				auto Draw = [&]() {
+					if (Op == 0) {
+						G::clear(Dst, 0xFF336699);
+						return;
+					}
+					tile(Dst, [&](int32_t x, int32_t y) {
+						if (Op == 1) G::blit(Src, NULL, Dst, x, y);
+						else if (Op == 2) G::blitKeyed(KeyedSrc, NULL, Dst, x, y, KeyColor);
+						else G::blitBlended(Src, NULL, Dst, x, y);
+					});
+				};
+				const double Rate = measure(Draw, Pixels, Millis);
+	
+				bool Matches = 1;
+				if (Op >= 2) {
+					// Draw once more over a known background for the comparison.
+					G::clear(Dst, 0x80336699);
+					Draw();
+					std::vector<uint32_t> Drawn;
+					for (int32_t y = 0; y < Dst.Height; y++) Drawn.insert(Drawn.end(), Dst.row(y), Dst.row(y) + Dst.Width);
+					if (Isa == G::DRAW_SCALAR) Expected[Op - 2] = Drawn; else Matches = (Drawn == Expected[Op - 2]);
+				}
+				std::printf("  %s %8.1f (%.2fx)%s", G::getDrawISAName(G::e_Draw_ISA(Isa)), Rate, Rate / SDLRate, Matches ? "" : " MISMATCH");
+			}
+			std::printf("\n");
+		}
+	
+		SDL_FreeSurface(Sprite);
+		SDL_FreeSurface(KeyedSprite);
+	}
+	SDL_Quit();
+	Anoptamin::Log::CleanupFiles();
+	return 0;
+}
@@ -0,0 +1,118 @@
+/********!
+ * @file  input_replay.cpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Headless load test of the input path: replays an input recording
+ *	into a window with a few typical hooks and an action map, one
+ *	recorded poll per frame, and reports what each poll cost.
+ * 
+ * @note
+ *	Usage: bench_input_replay.out <recording.ainp>
+ *	       bench_input_replay.out --synthesize <recording.ainp> [polls]
+ *	The second form writes a recording of generated keyboard and
+ *	high-rate mouse input, so no one has to sit at a keyboard.
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+#include "../include/input.hpp"
+
+//! Records 'polls' polls of generated input: a 1000 Hz mouse at 60 FPS, plus a key going down or up every few frames.
+void synthesize(Anoptamin::Base::c_SDLWindow& window, const char* path, uint32_t polls) {
+	const SDL_Scancode Keys[4] = {SDL_SCANCODE_W, SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D};
+	window.startInputRecording(path);
+	for (uint32_t i = 0; i < polls; i++) {
+		for (uint8_t m = 0; m < 16; m++) {
+			SDL_Event E = {};
+			E.type = SDL_MOUSEMOTION;
+			E.motion.xrel = 1 + (i + m) % 3;
+			E.motion.yrel = -1;
+			SDL_PushEvent(&E);
+		}
+		if (i % 4 == 0) {
+			SDL_Event E = {};
+			E.type = (i % 8 == 0) ? SDL_KEYDOWN : SDL_KEYUP;
+			E.key.keysym.scancode = Keys[(i / 8) % 4];
+			SDL_PushEvent(&E);
+		}
+		window.pollEvents();
+	}
+	window.stopInputRecording();
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2 || (std::string(argv[1]) == "--synthesize" && argc < 3)) {
+		std::cerr << "Usage: " << argv[0] << " <recording.ainp>\n       " << argv[0] << " --synthesize <recording.ainp> [polls]\n";
+		return 1;
+	}
+	Anoptamin::Log::SetupFiles();
+	Anoptamin::Log::SetLogThreshold(Anoptamin::Log::LOG_WARN);
+	Anoptamin::Base::c_InputReplay::useDummyVideoDriver();
+	assert_libsdl( SDL_Init(SDL_INIT_VIDEO) == 0 );
+	
+	int Status = 0;
+	{
+		Anoptamin::Base::c_SDLWindow Window(640, 480, "Input Replay", true);
+		if (std::string(argv[1]) == "--synthesize") {
+			synthesize(Window, argv[2], (argc > 3) ? uint32_t(std::stoul(argv[3])) : 10000);
+			std::cout << "Wrote '" << argv[2] << "'.\n";
+		} else {
+			// Typical game-side hooks: movement keys through a filter, mouse look on coalesced motion, and a catch-all.
+			volatile int32_t Look = 0;
+			size_t Moves = 0, Seen = 0;
+			Window.setMouseMotionCoalescing(true);
+			Window.addHook_KeyboardEvent([&](const SDL_Event* E, size_t N) { Moves += N; },
+				Anoptamin::Base::c_SDLEventFilter::keys({SDL_SCANCODE_W, SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D}));
+			Window.addHook_MouseMotionEvent([&](const SDL_Event* E, size_t N) { for (size_t i = 0; i < N; i++) Look = Look + E[i].motion.xrel; });
+			Window.addHook_KeyboardEvent([&](const SDL_Event* E, size_t N) { Seen += N; });
+			
+			// And the same movement keys as actions, fed from each poll's events.
+			Anoptamin::Base::c_ActionMap Actions;
+			Actions.bind(Actions.addAction("Forward"), Anoptamin::Base::c_InputBinding::key(SDL_SCANCODE_W));
+			Actions.bind(Actions.addAction("Left"), Anoptamin::Base::c_InputBinding::key(SDL_SCANCODE_A));
+			Actions.bind(Actions.addAction("Back"), Anoptamin::Base::c_InputBinding::key(SDL_SCANCODE_S));
+			Actions.bind(Actions.addAction("Right"), Anoptamin::Base::c_InputBinding::key(SDL_SCANCODE_D));
+			size_t Presses = 0;
+			
+			Anoptamin::Base::c_InputReplay Replay(argv[1], 0.0);
+			Replay.setWindowID(SDL_GetWindowID(Window.getRawSDLWindow()));
+			Anoptamin::Base::c_LatencyHistogram PollTimes;
+			while (!Replay.finished()) {
+				Replay.pump();
+				const uint64_t Start = Anoptamin::Base::clockTicks();
+				Actions.update(Window.pollEvents());
+				PollTimes.record(Anoptamin::Base::clockTicksToNanos(Anoptamin::Base::clockTicks() - Start));
+				for (uint16_t a = 0; a < Actions.getActionCount(); a++) Presses += Actions.pressed(a);
+			}
+			const Anoptamin::Base::c_LatencySummary S = PollTimes.getSummary();
+			std::cout << "Replayed " << Replay.getEventsPlayed() << " events in " << Replay.getPollsPlayed() << " polls.\n";
+			std::cout << "Nanoseconds per poll: p50 " << S.P50 << ", p99 " << S.P99 << ", max " << S.Max << '\n';
+			std::cout << "Hooks saw " << Moves << " movement key and " << Seen << " keyboard events.\n";
+			std::cout << "Movement actions were pressed " << Presses << " times.\n";
+			if (Replay.getEventsPlayed() == 0) Status = 2;
+		}
+	}
+	SDL_Quit();
+	Anoptamin::Log::CleanupFiles();
+	return Status;
+}
@@ -0,0 +1,96 @@
+/********!
+ * @file  log_filter.cpp
+ *
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ *
+ * @date
+ * 	16 October 2026
+ *
+ * @brief
+ * 	Measures what a logging macro costs when its severity is filtered
+ *	out at runtime, against building the same message unconditionally
+ *	(which is what the macros used to do) and against a real write.
+ *
+ * @note
+ *	Run from a directory where a 'logs' folder may be created.
+ *
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ *
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ *
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ********/
+
+#include "../include/base.hpp"
+
+constexpr uint32_t Iterations = 2000000;
+
+// Keeps the optimizer from throwing away the unconditional string build.
+volatile size_t Sink = 0;
+
+template<typename F> double nsPerCall(F&& body, uint32_t count) {
+	const uint64_t Start = Anoptamin::Base::clockTicks();
+	for (uint32_t i = 0; i < count; i++) body(i);
+	const uint64_t End = Anoptamin::Base::clockTicks();
+	return double(Anoptamin::Base::clockTicksToNanos(End - Start)) / count;
+}
+
+int main() {
+	Anoptamin::Log::SetupFiles();
+	Anoptamin::Log::SetLogThreshold(Anoptamin::Log::LOG_INFO);
+
+	double Empty = nsPerCall([](uint32_t i) { Sink = Sink + i; }, Iterations);
+
+	double Unconditional = nsPerCall([](uint32_t i) {
+		std::string Msg = "Created a new window with ID #" + std::to_string(i);
+		Sink = Sink + Msg.size();
+	}, Iterations);
+
+	double DisabledMsg = nsPerCall([](uint32_t i) {
+		Anoptamin_LogDebug("Created a new window with ID #" + std::to_string(i));
+		Sink = Sink + i;
+	}, Iterations);
+
+	double DisabledFmt = nsPerCall([](uint32_t i) {
+		Anoptamin_LogDebugF("Created a new window with ID #{}", i);
+		Sink = Sink + i;
+	}, Iterations);
+
+	double DisabledLazy = nsPerCall([](uint32_t i) {
+		Anoptamin_LogLazy(Anoptamin::Log::LOG_DEBUG, [&]() { return "Created a new window with ID #" + std::to_string(i); });
+		Sink = Sink + i;
+	}, Iterations);
+
+	Anoptamin::Log::SetLogThreshold(Anoptamin::Log::LOG_TRACE);
+	Anoptamin::Log::EnableBinaryLogging();
+	double EnabledBinary = nsPerCall([](uint32_t i) {
+		Anoptamin_LogDebugF("Created a new window with ID #{}", i);
+	}, Iterations / 10);
+	Anoptamin::Log::DisableBinaryLogging();
+
+	double EnabledText = nsPerCall([](uint32_t i) {
+		Anoptamin_LogDebug("Created a new window with ID #" + std::to_string(i));
+	}, Iterations / 100);
+
+	std::cout << "Nanoseconds per call (loop overhead " << Empty << " ns already included):\n";
+	std::cout << "  unconditional message build:  " << Unconditional << '\n';
+	std::cout << "  disabled Anoptamin_LogDebug:  " << DisabledMsg << '\n';
+	std::cout << "  disabled Anoptamin_LogDebugF: " << DisabledFmt << '\n';
+	std::cout << "  disabled Anoptamin_LogLazy:   " << DisabledLazy << '\n';
+	std::cout << "  enabled, binary log:          " << EnabledBinary << '\n';
+	std::cout << "  enabled, text log:            " << EnabledText << '\n';
+
+	Anoptamin::Log::CleanupFiles();
+	return 0;
+}
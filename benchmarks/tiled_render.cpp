@@ -0,0 +1,146 @@
+/********!
+ * @file  tiled_render.cpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Measures how the tiled renderer scales from one thread to every
+ *	thread of the worker pool, drawing a busy scene (a clear, a few
+ *	thousand alpha blended and color-keyed sprites, and some fills) to
+ *	1080p and 1440p window surfaces under the dummy video driver.
+ * 
+ * @note
+ *	Usage: bench_tiled_render.out [frames per measurement]
+ *	Each frame is also checked to come out the same as drawing the
+ *	scene directly on one thread.
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+#include "../include/sdl.hpp"
+#include "../include/draw.hpp"
+
+namespace G = Anoptamin::Graphics;
+
+struct c_Sprites {
+	std::vector<uint32_t> Blended, Keyed;
+	G::c_PixelView BlendedView, KeyedView;
+};
+static constexpr uint32_t KeyColor = 0x00FF00FF;
+
+//! Makes a 64x64 disc with a soft edge, and a 32x32 color-keyed diamond.
+c_Sprites makeSprites() {
+	c_Sprites S;
+	S.Blended.resize(64 * 64);
+	S.Keyed.resize(32 * 32);
+	for (int32_t y = 0; y < 64; y++) {
+		for (int32_t x = 0; x < 64; x++) {
+			const float Edge = 30.0f - std::hypot(x - 31.5f, y - 31.5f);
+			const uint32_t Alpha = (Edge >= 1) ? 200 : (Edge <= 0) ? 0 : uint32_t(Edge * 200);
+			S.Blended[y * 64 + x] = (Alpha << 24) | (uint32_t(x * 4) << 16) | (uint32_t(y * 4) << 8) | 0x40;
+		}
+	}
+	for (int32_t y = 0; y < 32; y++) {
+		for (int32_t x = 0; x < 32; x++) S.Keyed[y * 32 + x] = (std::abs(x - 16) + std::abs(y - 16) < 15) ? 0xFFE0C020 : KeyColor;
+	}
+	S.BlendedView = {S.Blended.data(), 64, 64, 64};
+	S.KeyedView = {S.Keyed.data(), 32, 32, 32};
+	return S;
+}
+
+//! Draws the scene through any drawer with the c_TiledRenderer recording calls.
+template <typename DrawerT>
+void drawScene(DrawerT& drawer, const c_Sprites& sprites, int32_t width, int32_t height, uint32_t frame) {
+	uint32_t Seed = 12345 + frame;
+	auto Next = [&Seed]() {
+		Seed = Seed * 1664525u + 1013904223u;
+		return Seed >> 8;
+	};
+	drawer.clear(0xFF102030);
+	for (uint16_t i = 0; i < 200; i++) {
+		const SDL_Rect R = {int32_t(Next() % width), int32_t(Next() % height), 40, 20};
+		drawer.fillRect(&R, 0xFF000000 | Next());
+	}
+	for (uint16_t i = 0; i < 2000; i++) drawer.blitBlended(sprites.BlendedView, NULL, int32_t(Next() % width) - 32, int32_t(Next() % height) - 32);
+	for (uint16_t i = 0; i < 500; i++) drawer.blitKeyed(sprites.KeyedView, NULL, int32_t(Next() % width) - 16, int32_t(Next() % height) - 16, KeyColor);
+}
+
+//! Draws straight to a view, on the calling thread, with the same calls as the renderer records.
+struct c_DirectDrawer {
+	G::c_PixelView Target;
+	void clear(uint32_t color) { G::clear(Target, color); }
+	void fillRect(const SDL_Rect* rect, uint32_t color) { G::fillRect(Target, rect, color); }
+	void blitBlended(const G::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y) { G::blitBlended(src, srcRect, Target, x, y); }
+	void blitKeyed(const G::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y, uint32_t key) {
+		G::blitKeyed(src, srcRect, Target, x, y, key);
+	}
+};
+
+//! Snapshots a view's pixels, row by row.
+std::vector<uint32_t> pixelsOf(const G::c_PixelView& view) {
+	std::vector<uint32_t> Out;
+	for (int32_t y = 0; y < view.Height; y++) Out.insert(Out.end(), view.row(y), view.row(y) + view.Width);
+	return Out;
+}
+
+int main(int argc, char** argv) {
+	const uint32_t Frames = (argc > 1) ? uint32_t(std::stoul(argv[1])) : 60;
+	Anoptamin::Log::SetupFiles();
+	Anoptamin::Log::SetLogThreshold(Anoptamin::Log::LOG_WARN);
+	Anoptamin::Base::c_InputReplay::useDummyVideoDriver();
+	assert_libsdl( SDL_Init(SDL_INIT_VIDEO) == 0 );
+	
+	const c_Sprites Sprites = makeSprites();
+	Anoptamin::Base::c_WorkerPool& Pool = Anoptamin::Base::c_WorkerPool::getShared();
+	std::cout << "Drawing kernels " << G::getDrawISAName(G::getDrawISA()) << ", " << (Pool.getThreadCount() + 1)
+		<< " threads at most. Milliseconds per frame:\n";
+	
+	const int32_t Sizes[2][2] = {{1920, 1080}, {2560, 1440}};
+	for (const auto& Size : Sizes) {
+		Anoptamin::Base::c_SDLWindow Window(Size[0], Size[1], "Tiled Rendering", true);
+		const G::c_PixelView Target = G::c_PixelView::of(Window.getRawSDLSurface());
+	
+		c_DirectDrawer Direct = {Target};
+		uint64_t Start = Anoptamin::Base::clockNanos();
+		for (uint32_t f = 0; f < Frames; f++) drawScene(Direct, Sprites, Target.Width, Target.Height, f);
+		const double DirectMillis = double(Anoptamin::Base::clockNanos() - Start) / 1e6 / Frames;
+		const std::vector<uint32_t> Expected = pixelsOf(Target);
+		std::printf("  %dx%d: direct %.2f\n", Size[0], Size[1], DirectMillis);
+	
+		G::c_TiledRenderer Renderer;
+		double OneThread = 0;
+		for (uint16_t Threads = 1; Threads <= Pool.getThreadCount() + 1; Threads++) {
+			Renderer.setThreads(Threads);
+			Start = Anoptamin::Base::clockNanos();
+			for (uint32_t f = 0; f < Frames; f++) {
+				drawScene(Renderer, Sprites, Target.Width, Target.Height, f);
+				Window.drawTiled(Renderer);
+			}
+			const double Millis = double(Anoptamin::Base::clockNanos() - Start) / 1e6 / Frames;
+			if (Threads == 1) OneThread = Millis;
+			std::printf("    %2u threads: %7.2f  (%.2fx one thread, %.2fx direct)%s\n", Threads, Millis, OneThread / Millis,
+				DirectMillis / Millis, (pixelsOf(Target) == Expected) ? "" : " MISMATCH");
+		}
+	}
+	SDL_Quit();
+	Anoptamin::Log::CleanupFiles();
+	return 0;
+}
@@ -10,15 +10,16 @@
  * @brief
  * 	Provides base C++STL includes, minor SDL2 includes, utility macros,
  *	program hooks, and general assertion support, as well as the base
- *	logging facility for the game itself. Provides includes in:
+ *	logging facility and monotonic clock for the game itself. Provides includes in:
  *		Anoptamin::Base
  *		Anoptamin::Log
  *
  * @note
  *	Since the BASE functionality is intended to be established before
  *	the use of any concurrency, the only thread-safe functions are
- *	the general logging functions. Everything else is either a once-called
- *	and/or an abort-the-program-called sort of deal.
+ *	the general logging functions and c_Function_Hook. Everything else is either a once-called
+ *	and/or an abort-the-program-called sort of deal. The asynchronous
+ *	logging mode must be enabled and disabled from the main thread.
  * 
  * @copyright
  * 	Copyright (C) 2023 Evan Clegern
@@ -169,17 +170,28 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+
+// Standard Library Memory
+#include <memory>
+#include <new>
 
 // Standard Library Storage Primitives
 #include <vector>
 #include <string>
 #include <array>
+#include <deque>
+#include <cstring>
+#include <type_traits>
 
 // Standard Library Utilities
 #include <stdexcept>
+#include <cstddef>
 #include <cstdlib>
 #include <cerrno>
 #include <random>
+#include <chrono>
+#include <algorithm>
 #include <cmath>
 #include <ctime>
 
@@ -193,6 +205,14 @@
 // GLIBC backtrace. Only include from the GNU C library.
 #include <execinfo.h>
 
+// Timestamp counter intrinsics, for the fast clock path.
+#if LIBANOP_GNU && (defined(__x86_64__) || defined(__i386__))
+	#define LIBANOP_CLOCK_TSC 1
+	#include <x86intrin.h>
+#else
+	#define LIBANOP_CLOCK_TSC 0
+#endif
+
 // Utilities (Stacktraces, assertions, macro stringifies, and logging)
 
 #ifndef anoptamin_utilities
@@ -205,7 +225,7 @@ namespace Anoptamin { namespace Base {
 	static std::filesystem::path anoptamin_LOGpath;
 	static std::filesystem::path anoptamin_BASEpath;
 	static std::ofstream anoptamin_logf;
-	static std::clock_t anoptamin_stclock;
+	static uint64_t anoptamin_stclock; // Clock ticks (see clockTicks) when logging was set up.
 	static bool anoptamin_logopen = 0;
 
 	//! Performs a semi-demangled stacktrace, and prints to stderr.
@@ -268,9 +288,65 @@ namespace Anoptamin { namespace Base {
 	#define check_runtime(cond) if (!(cond)) {Anoptamin::Base::dbg_checkfunc("Runtime", __PRETTY_FUNCTION__, __LINE__, __FILE__, anoptamin_stringify(cond)); throw std::runtime_error("Runtime");};
 #endif
 
+#ifndef anoptamin_clock
+#define anoptamin_clock 1
+
+// High-resolution monotonic clock. Uses the calibrated TSC where it is invariant, otherwise CLOCK_MONOTONIC.
+// Readings are comparable across threads, unlike std::clock(), which is process CPU time.
+namespace Anoptamin { namespace Base {
+	//! Set once the TSC has been calibrated against the monotonic clock and found to be invariant.
+	LIBANOP_FUNC_IMPORT bool anoptamin_clocktsc;
+	//! Nanoseconds per clock tick, as a 32.32 fixed point value.
+	LIBANOP_FUNC_IMPORT uint64_t anoptamin_clockmult;
+	
+	//! Calibrates the TSC against the monotonic clock (takes about 5ms). Already done when the library is loaded. Not thread safe.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT clockCalibrate();
+	
+	//! Reads the OS monotonic clock in nanoseconds. This is the fallback path of clockTicks().
+	inline uint64_t clockMonotonicNanos() {
+	#if LIBANOP_WINDOWS
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	#else
+		timespec T;
+		clock_gettime(CLOCK_MONOTONIC, &T);
+		return uint64_t(T.tv_sec) * 1000000000ull + uint64_t(T.tv_nsec);
+	#endif
+	}
+	
+	//! Reads the raw clock. Only differences between readings are meaningful; convert them with clockTicksToNanos().
+	inline uint64_t clockTicks() {
+	#if LIBANOP_CLOCK_TSC
+		if (anoptamin_clocktsc) return __rdtsc();
+	#endif
+		return clockMonotonicNanos();
+	}
+	
+	//! Converts a clock tick count (or difference) into nanoseconds.
+	inline uint64_t clockTicksToNanos(uint64_t ticks) {
+	#if LIBANOP_GNU && defined(__SIZEOF_INT128__)
+		return uint64_t((static_cast<unsigned __int128>(ticks) * anoptamin_clockmult) >> 32);
+	#else
+		return uint64_t(double(ticks) * (double(anoptamin_clockmult) / 4294967296.0));
+	#endif
+	}
+	
+	//! Gets the current clock reading in nanoseconds.
+	inline uint64_t clockNanos() {
+		return clockTicksToNanos(clockTicks());
+	}
+}} // End Anoptamin::Base
+
+#endif
+
 #ifndef anoptamin_logging
 #define anoptamin_logging 1
 
+//! Compile-time minimum log severity (see e_LogSeverity). Logging macros below this level compile to nothing.
+//! FATAL can never be removed. Override with e.g. -DLIBANOP_LOG_MIN_SEVERITY=3 for release builds.
+#ifndef LIBANOP_LOG_MIN_SEVERITY
+	#define LIBANOP_LOG_MIN_SEVERITY 0
+#endif
+
 namespace Anoptamin { namespace Log {
 	//! Sets up the session log file and gets the temporary files directory from the current directory. Not thread safe.
 	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT SetupFiles();
@@ -292,18 +368,158 @@ namespace Anoptamin { namespace Log {
 	void LIBANOP_FUNC_COLD LIBANOP_FUNC_NOINLINE LIBANOP_FUNC_IMPORT LogTrace();
 	std::mutex LogTrace_Mutex;
 	
-	//! Logs a given message with severity.
+	//! Logs a given message with severity. While binary logging is on, only FATAL records reach the text log (see EnableBinaryLogging).
 	void LIBANOP_FUNC_HOT LIBANOP_FUNC_NOINLINE LIBANOP_FUNC_IMPORT Log(e_LogSeverity SEV, std::string MSG);
 	std::mutex Log_Mutex;
+	
+	//! Runtime minimum severity for the logging macros. Read with one relaxed load before any message is built.
+	LIBANOP_FUNC_IMPORT std::atomic<uint8_t> LogThreshold;
+	
+	//! Sets the runtime minimum severity for the logging macros. FATAL is always logged. Thread safe.
+	void LIBANOP_FUNC_IMPORT SetLogThreshold(e_LogSeverity SEV);
+	
+	//! Tests if a macro call at this severity would be logged. Folds to a constant for levels removed at compile time.
+	inline bool LogEnabled(e_LogSeverity SEV) {
+		if (SEV >= LOG_FATAL) return true;
+		if (SEV < LIBANOP_LOG_MIN_SEVERITY) return false;
+		return SEV >= LogThreshold.load(std::memory_order_relaxed);
+	}
+	
+	//! What a producer does when the asynchronous log ring is full.
+	enum e_LogOverflow : uint8_t {
+		OVERFLOW_BLOCK,       //! Wait for the writer thread to make room. Nothing is lost.
+		OVERFLOW_DROP_NEWEST, //! Discard the record being logged.
+		OVERFLOW_DROP_OLDEST  //! Discard the oldest queued record to make room for the new one.
+	};
+	
+	//! Switches Log() over to a bounded lock-free ring drained by a background writer thread, which batches records into large writes.
+	//! The capacity is rounded up to a power of two. FATAL records still flush everything and are written synchronously. Not thread safe.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT EnableAsyncLogging(e_LogOverflow policy = OVERFLOW_BLOCK, size_t capacity = 4096);
+	
+	//! Flushes the ring, stops the writer thread and returns Log() to synchronous writes. Not thread safe.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT DisableAsyncLogging();
+	
+	//! Blocks until every record logged before this call has been written to the logfile, then flushes the file.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT FlushLogs();
+	
+	//! Gets the number of records discarded by the DROP overflow policies since logging was set up.
+	uint64_t LIBANOP_FUNC_IMPORT GetDroppedLogs();
+	
+	//! Appends one line in the standard "[ LEVEL  ] (+ticks) message" layout to 'out'.
+	void LIBANOP_FUNC_IMPORT FormatLogLine(std::string& out, e_LogSeverity SEV, uint64_t timediff, const std::string& MSG);
+	
+	//! Argument type codes stored in binary log descriptors.
+	enum e_LogArgType : uint8_t {
+		LOGARG_INT = 1, //! Any signed integer or enum, packed as 8 bytes
+		LOGARG_UINT,    //! Any unsigned integer or bool, packed as 8 bytes
+		LOGARG_FLOAT,   //! Any floating point, packed as an 8-byte double
+		LOGARG_STRING   //! C or C++ string, packed as a 16-bit length and its bytes (see LogStringTruncated)
+	};
+	
+	//! Static per-call-site descriptor for the format logging macros. 'ID' is assigned by the binary log on first use.
+	struct c_LogDescriptor {
+		const char* Format;
+		e_LogSeverity Severity;
+		std::atomic<uint32_t> ID;
+	};
+	
+	//! Largest argument payload a single binary record can carry; long strings are truncated to fit.
+	constexpr size_t LogMaxPayload = 480;
+	//! Set in a packed string's length when the string was cut short to fit the payload. Rendering marks the cut.
+	constexpr uint16_t LogStringTruncated = 0x8000;
+	
+	//! Opens '<session log>.alog' next to the text log. From then on every record (besides stacktraces) goes to the binary file,
+	//! and the format logging macros only store their descriptor ID and raw argument bytes. Not thread safe.
+	//! The text log stops receiving anything but FATAL records and their stacktraces until DisableBinaryLogging; the rest
+	//! is read back with tools/alog_decode. Plain Log() messages are stored as one string argument, so they are truncated too.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT EnableBinaryLogging();
+	
+	//! Flushes and closes the binary log; records go back to the text log. Not thread safe.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT DisableBinaryLogging();
+	
+	//! Writes a packed record for a call site. If the binary log is not open, it is rendered and handed to Log() instead.
+	void LIBANOP_FUNC_HOT LIBANOP_FUNC_IMPORT WriteBinaryRecord(c_LogDescriptor& D, const uint8_t* Codes, uint8_t Argc, const uint8_t* Data, uint16_t Len);
+	
+	//! Expands the "{}" placeholders of 'Format' with the packed arguments. Used by the text fallback and the offline decoder.
+	std::string LIBANOP_FUNC_IMPORT RenderBinaryRecord(const char* Format, const uint8_t* Codes, uint8_t Argc, const uint8_t* Data, uint16_t Len);
+	
+	template<typename T> constexpr uint8_t LogArgCode() {
+		typedef typename std::decay<T>::type U;
+		if constexpr (std::is_floating_point<U>::value) return LOGARG_FLOAT;
+		else if constexpr (std::is_enum<U>::value) return LOGARG_INT;
+		else if constexpr (std::is_integral<U>::value && std::is_signed<U>::value) return LOGARG_INT;
+		else if constexpr (std::is_integral<U>::value) return LOGARG_UINT;
+		else return LOGARG_STRING;
+	}
+	
+	inline void LogArgPackString(uint8_t* buf, size_t& pos, const char* str, size_t len) {
+		if (pos + 2 > LogMaxPayload) return; // No room left even for the length; dropped, as numbers are.
+		const size_t room = LogMaxPayload - pos - 2;
+		const uint16_t N = uint16_t(len < room ? len : room);
+		const uint16_t Stored = (N < len) ? uint16_t(N | LogStringTruncated) : N;
+		std::memcpy(buf + pos, &Stored, 2); std::memcpy(buf + pos + 2, str, N);
+		pos += 2 + N;
+	}
+	
+	template<typename T> inline void LogArgPack(uint8_t* buf, size_t& pos, const T& arg) {
+		constexpr uint8_t Code = LogArgCode<T>();
+		if constexpr (Code == LOGARG_STRING) {
+			if constexpr (std::is_convertible<T, const char*>::value) {
+				const char* str = arg;
+				if (str == NULL) str = "(null)";
+				LogArgPackString(buf, pos, str, std::strlen(str));
+			} else {
+				LogArgPackString(buf, pos, arg.data(), arg.size());
+			}
+		} else if (pos + 8 <= LogMaxPayload) {
+			if constexpr (Code == LOGARG_FLOAT) { const double V = arg; std::memcpy(buf + pos, &V, 8); }
+			else if constexpr (Code == LOGARG_INT) { const int64_t V = int64_t(arg); std::memcpy(buf + pos, &V, 8); }
+			else { const uint64_t V = uint64_t(arg); std::memcpy(buf + pos, &V, 8); }
+			pos += 8;
+		}
+	}
+	
+	//! Packs the arguments of a format logging call into raw bytes, without formatting anything.
+	template<typename... Args> inline void LogFormatted(c_LogDescriptor& D, const Args&... args) {
+		static_assert(sizeof...(Args) < 32, "Too many arguments for a single log record.");
+		static constexpr uint8_t Codes[sizeof...(Args) + 1] = { LogArgCode<Args>()..., 0 };
+		uint8_t Data[LogMaxPayload];
+		size_t pos = 0;
+		(LogArgPack(Data, pos, args), ...);
+		WriteBinaryRecord(D, Codes, uint8_t(sizeof...(Args)), Data, uint16_t(pos));
+	}
 }} // End Anoptamin::Log
 
-#define Anoptamin_LogTrace(msg)  Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_TRACE, msg)
-#define Anoptamin_LogDebug(msg)  Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_DEBUG, msg)
-#define Anoptamin_LogCommon(msg) Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_COMMON, msg)
-#define Anoptamin_LogInfo(msg)   Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_INFO, msg)
-#define Anoptamin_LogWarn(msg)   Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_WARN, msg)
-#define Anoptamin_LogError(msg)  Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_ERROR, msg)
-#define Anoptamin_LogFatal(msg)  Anoptamin::Log::Log(Anoptamin::Log::e_LogSeverity::LOG_FATAL, msg)
+// The severity is checked before 'msg' is evaluated, so disabled calls never build their message.
+#define Anoptamin_LogAt(sev, msg) do { \
+	if (Anoptamin::Log::LogEnabled(sev)) Anoptamin::Log::Log(sev, msg); } while (0)
+
+#define Anoptamin_LogTrace(msg)  Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_TRACE, msg)
+#define Anoptamin_LogDebug(msg)  Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_DEBUG, msg)
+#define Anoptamin_LogCommon(msg) Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_COMMON, msg)
+#define Anoptamin_LogInfo(msg)   Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_INFO, msg)
+#define Anoptamin_LogWarn(msg)   Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_WARN, msg)
+#define Anoptamin_LogError(msg)  Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_ERROR, msg)
+#define Anoptamin_LogFatal(msg)  Anoptamin_LogAt(Anoptamin::Log::e_LogSeverity::LOG_FATAL, msg)
+
+//! Lazy logging. 'builder' is any callable returning the message, and is only called if the severity is enabled.
+#define Anoptamin_LogLazy(sev, builder) do { \
+	if (Anoptamin::Log::LogEnabled(sev)) Anoptamin::Log::Log(sev, (builder)()); } while (0)
+
+// Format logging. 'fmt' must be a string literal using "{}" placeholders; the arguments are only formatted when read,
+// and are not evaluated at all if the severity is disabled.
+#define Anoptamin_LogFormatted(sev, fmt, ...) do { \
+	if (Anoptamin::Log::LogEnabled(sev)) { \
+		static Anoptamin::Log::c_LogDescriptor anoptamin_logdesc = { fmt, sev, {0} }; \
+		Anoptamin::Log::LogFormatted(anoptamin_logdesc, ##__VA_ARGS__); } } while (0)
+
+#define Anoptamin_LogTraceF(fmt, ...)  Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_TRACE, fmt, ##__VA_ARGS__)
+#define Anoptamin_LogDebugF(fmt, ...)  Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_DEBUG, fmt, ##__VA_ARGS__)
+#define Anoptamin_LogCommonF(fmt, ...) Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_COMMON, fmt, ##__VA_ARGS__)
+#define Anoptamin_LogInfoF(fmt, ...)   Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_INFO, fmt, ##__VA_ARGS__)
+#define Anoptamin_LogWarnF(fmt, ...)   Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_WARN, fmt, ##__VA_ARGS__)
+#define Anoptamin_LogErrorF(fmt, ...)  Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_ERROR, fmt, ##__VA_ARGS__)
+#define Anoptamin_LogFatalF(fmt, ...)  Anoptamin_LogFormatted(Anoptamin::Log::e_LogSeverity::LOG_FATAL, fmt, ##__VA_ARGS__)
 
 #endif
 
@@ -313,28 +529,211 @@ namespace Anoptamin { namespace Log {
 // Implementation of basic hook-events
 namespace Anoptamin { namespace Base {
 	//! Holds return data from a Hooked function; the 'MainData' is intended for serializing whatever is needed.
+	//! 'ElapsedTicks' is the time spent in the function in nanoseconds (see clockNanos). The hook measures and fills it in itself.
 	struct c_HookReturn {
 		std::vector<uint8_t> MainData;
 		uint32_t ElapsedTicks;
 		bool Valid;
 	};
 	
+	//! Percentiles read back from a c_LatencyHistogram, all in nanoseconds.
+	struct c_LatencySummary {
+		uint64_t Count = 0, P50 = 0, P99 = 0, Max = 0;
+	};
+	
+	//! Lock-free log-linear (HDR style) histogram of nanosecond latencies. Each power of two is split into 16 buckets,
+	//! so percentiles are within about 6% of the recorded value, from 1ns up to 2^41ns (about 36 minutes).
+	class c_LatencyHistogram {
+	public:
+		static constexpr uint16_t SubBuckets = 16, Buckets = 38 * SubBuckets;
+	private:
+		std::atomic<uint32_t> m_counts[Buckets];
+		std::atomic<uint64_t> m_total, m_max;
+	public:
+		c_LatencyHistogram();
+		
+		//! Maps a latency onto its bucket.
+		static inline uint16_t bucketOf(uint64_t ns) {
+			if (ns < SubBuckets) return uint16_t(ns);
+			const uint32_t Msb = 63 - __builtin_clzll(ns);
+			const uint32_t Index = (Msb - 3) * SubBuckets + uint32_t((ns >> (Msb - 4)) & (SubBuckets - 1));
+			return uint16_t(Index < Buckets ? Index : Buckets - 1);
+		}
+		//! Gets the largest latency that maps onto a bucket.
+		static uint64_t bucketHighest(uint16_t bucket);
+		
+		//! Records one latency. Safe to call from any number of threads.
+		inline void record(uint64_t ns) {
+			m_counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+			m_total.fetch_add(1, std::memory_order_relaxed);
+			uint64_t Max = m_max.load(std::memory_order_relaxed);
+			while (ns > Max && !m_max.compare_exchange_weak(Max, ns, std::memory_order_relaxed)) {}
+		}
+		//! Gets the latency below which 'percent' of the recordings fall.
+		uint64_t getPercentile(double percent) const;
+		//! Gets the count, p50, p99 and max.
+		c_LatencySummary getSummary() const;
+		//! Clears every recording.
+		void reset();
+	};
+	
+	//! Signature of every hookable function.
+	typedef c_HookReturn (*c_HookFuncPtr)(size_t, uint16_t, const void*);
+	//! Identifies one hooked entry, across every hook. Zero is never handed out.
+	typedef uint32_t c_HookHandle;
+	
+	//! Type-erased callable with in-place storage, so a hooked function can carry captured state without a heap allocation.
+	//! Stores anything copyable up to 'Capacity' bytes that can be called (as const) with (const void* Data, size_t Count, uint16_t SizeData).
+	class c_HookCallable {
+	public:
+		static constexpr size_t Capacity = 48;
+	private:
+		alignas(std::max_align_t) unsigned char m_storage[Capacity];
+		c_HookReturn (*m_call)(const unsigned char*, const void*, size_t, uint16_t) = NULL;
+		//! Copy-constructs 'Src' into 'Dest', or destroys 'Dest' if 'Src' is NULL.
+		void (*m_manage)(unsigned char* Dest, const unsigned char* Src) = NULL;
+		
+		template<typename F> static c_HookReturn callStored(const unsigned char* Storage, const void* Data, size_t Count, uint16_t SizeData) {
+			return (*reinterpret_cast<const F*>(Storage))(Data, Count, SizeData);
+		}
+		template<typename F> static void manageStored(unsigned char* Dest, const unsigned char* Src) {
+			if (Src != NULL) new (Dest) F(*reinterpret_cast<const F*>(Src));
+			else reinterpret_cast<F*>(Dest)->~F();
+		}
+	public:
+		c_HookCallable() = default;
+		
+		template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_HookCallable>::value>::type>
+		c_HookCallable(F&& callable) {
+			typedef typename std::decay<F>::type Stored;
+			static_assert(sizeof(Stored) <= Capacity, "Hooked callable captures too much state; capture a pointer instead.");
+			static_assert(alignof(Stored) <= alignof(std::max_align_t), "Hooked callable is over-aligned.");
+			new (m_storage) Stored(std::forward<F>(callable));
+			m_call = &callStored<Stored>;
+			m_manage = &manageStored<Stored>;
+		}
+		c_HookCallable(const c_HookCallable& b) : m_call(b.m_call), m_manage(b.m_manage) {
+			if (m_manage != NULL) m_manage(m_storage, b.m_storage);
+		}
+		c_HookCallable& operator=(const c_HookCallable& b) {
+			if (this == &b) return *this;
+			if (m_manage != NULL) m_manage(m_storage, NULL);
+			m_call = b.m_call; m_manage = b.m_manage;
+			if (m_manage != NULL) m_manage(m_storage, b.m_storage);
+			return *this;
+		}
+		~c_HookCallable() {
+			if (m_manage != NULL) m_manage(m_storage, NULL);
+		}
+		
+		explicit operator bool() const noexcept { return m_call != NULL; }
+		c_HookReturn operator()(const void* Data, size_t Count, uint16_t SizeData) const {
+			return m_call(m_storage, Data, Count, SizeData);
+		}
+	};
+	
 	//! Holds the pointer and some flags for a hookable function.
 	//! All hookable functions must take the parameter vector size (size_t), the vector type size (uint16_t), and the input data (const void*).
 	//! All hookable functions must return the 'c_HookReturn' data and update its fields accordingly.
 	//! All hookable functions cannot utilize multithreading! They must be designed and optimized for single thread execution.
+	//! On a hook with ParallelInvoke set, functions may be called from the shared worker pool; see Func_Independent.
 	struct c_Hookable_Func {
 		bool Func_NoInputs = 0;
 		c_HookReturn (*Function)(size_t, uint16_t, const void*);
+		//! Set if this function shares no state with the other functions on its hook (besides its Func_RunsAfter edges),
+		//! so that parallel invokes may run it alongside them. Unset functions run one at a time, in registration order.
+		bool Func_Independent = 0;
+		//! Hooked functions which must have finished before this one starts. Any order that cannot be met is rejected.
+		std::vector<c_HookFuncPtr> Func_RunsAfter = {};
+		//! Same as Func_RunsAfter, for entries known by their handle (such as typed handlers, which have no Function).
+		std::vector<c_HookHandle> Func_RunsAfterHandles = {};
+		//! Handed out by HookFunction; whatever is set here beforehand is replaced.
+		c_HookHandle Func_Handle = 0;
+		//! Called instead of 'Function' when set. Normally filled in by c_TypedHook::makeHookable.
+		c_HookCallable Func_Callable = {};
+		//! Latencies measured by the hook for this entry. Created by HookFunction, and kept when the list is copied.
+		std::shared_ptr<c_LatencyHistogram> Func_Latency = {};
+	};
+	
+	//! Immutable list of hooked functions as published by a c_Function_Hook, along with its precomputed run order.
+	struct c_HookList {
+		std::vector<c_Hookable_Func> Funcs;
+		std::vector<uint16_t> Order;                   // Topological order, used by serial invokes.
+		std::vector<uint16_t> DepCount;                // Number of functions which must finish before each one.
+		std::vector<std::vector<uint16_t>> Dependents; // Functions waiting on each one.
+		bool HasParallelism = 0;                       // Whether more than one function can ever be ready at once.
+	};
+	typedef std::shared_ptr<const c_HookList> c_HookSnapshot;
+	
+	//! Small fixed pool of worker threads for fan-out work. Tasks are plain function pointers with a context pointer,
+	//! and must not throw. Threads waiting on their tasks should call runOne() to help, rather than blocking.
+	class c_WorkerPool {
+		struct c_Task {
+			void (*Function)(void*);
+			void* Context;
+		};
+		std::vector<std::thread> m_threads;
+		std::deque<c_Task> m_tasks;
+		std::mutex m_lock;
+		std::condition_variable m_wake;
+		bool m_stopping = 0;
+		
+		void workerLoop();
+	public:
+		//! Starts 'threads' workers; zero means one less than the hardware concurrency (at least one).
+		c_WorkerPool(uint16_t threads = 0);
+		//! Finishes the queued tasks and joins the workers.
+		~c_WorkerPool();
+		//! Queues a task.
+		void submit(void (*function)(void*), void* context);
+		//! Runs one queued task on the calling thread. Returns false if there was nothing queued.
+		bool runOne();
+		//! Gets the number of worker threads.
+		const uint16_t getThreadCount() const noexcept;
+		//! Gets the pool shared by the whole program, which is created on first use.
+		static c_WorkerPool& getShared();
+	};
+	
+	//! Multiple-producer, single-consumer queue of hook payloads, all of one size. Producers copy their items into the
+	//! pending buffer under a short lock; the consumer swaps the whole buffer out and reads it without holding the lock,
+	//! so producers never wait on a running hook, and once both buffers have grown nothing gets allocated.
+	class c_DeferredQueue {
+		std::mutex m_lock;
+		std::vector<uint8_t> m_pending, m_taken;
+		uint16_t m_itemSize = 0;
+		std::atomic<size_t> m_count{0};
+	public:
+		//! Copies 'Count' items of 'SizeData' bytes onto the queue. Safe from any thread.
+		void push(const void* Data, size_t Count, uint16_t SizeData);
+		//! Takes everything queued so far, and sets 'SizeData' to its item size. Consumer only; the returned
+		//! buffer stays valid until the next call. If 'Expected' is set and the items are some other size, this
+		//! throws and leaves them queued.
+		const std::vector<uint8_t>& take(uint16_t& SizeData, uint16_t Expected = 0);
+		//! Gets the number of items waiting (a hint while producers are still running).
+		size_t size() const noexcept { return m_count.load(std::memory_order_relaxed); }
 	};
 	
 	//! Allows for proper functions to be registered under a hook, which then can be invoked to call its child functions.
-	//! Uses MUTEXES in order to provide thread safety on its end; cannot be guaranteed for Hookable Functions (beyond stipulated above).
+	//! The function list is read-copy-update: writers copy it and publish the new list through a plain atomic pointer, so any
+	//! number of threads can Invoke at once and never wait on (or race with) HookFunction/UnhookFunction. This cannot be guaranteed
+	//! for Hookable Functions (beyond stipulated above); invocations already running keep the list they started with.
+	//! Replaced lists are retired rather than freed: invokes count themselves in under the current HookEpoch, and a later write
+	//! frees what was retired two epochs back once nothing is counted under that epoch any more. The writer never waits for
+	//! invokes, and an invoke takes no lock; it costs an atomic increment and decrement of its epoch's reader count.
 	struct c_Function_Hook {
 		std::string Name;
-		std::vector<c_Hookable_Func> HookedFuncs;
-		std::mutex HookLock, InvokeLock; // Only one thread can invoke the hook at a time.
+		std::atomic<const c_HookList*> HookedFuncs; // The published list, owned by HookedOwner. Read while counted in HookReaders.
+		std::atomic<uint32_t> HookEpoch; // Advanced by writers, once the readers from two epochs back have left.
+		std::atomic<uint32_t> HookReaders[2]; // Invokes in progress, by the parity of the epoch they started in.
+		c_HookSnapshot HookedOwner; // Owns the published list. Only touched under HookLock.
+		std::vector<c_HookSnapshot> HookedRetired[2]; // Lists replaced this epoch, and in the one before. Only touched under HookLock.
+		mutable std::mutex HookLock; // Serializes writers (and getHookedFuncs) only.
 		bool CatchHookedErrors;
+		//! Opt-in: fan the functions out across c_WorkerPool::getShared(), following their Func_Independent and
+		//! Func_RunsAfter annotations. Invoke still returns only once every function has finished.
+		bool ParallelInvoke = 0;
+		//! Items raised from other threads, waiting for the owner of the hook to drain them (see Defer).
+		c_DeferredQueue Deferred;
 		
 		c_Function_Hook(const char* title, bool catchErrs = 0);
 		
@@ -343,38 +742,158 @@ namespace Anoptamin { namespace Base {
 		//! Copies over the name and hook config, but none of the hooked functions.
 		c_Function_Hook(const c_Function_Hook& b);
 		
+		//! Removes the hook from the latency report.
+		~c_Function_Hook();
+		
+		//! Gets the latency percentiles the hook measured for its function #index (counting from zero).
+		c_LatencySummary getLatency(uint16_t index) const;
+		
 		//! Adds a new function to the list of hooked functions, and returns the size of the current HookedFuncs vector.
-		uint16_t HookFunction(const c_Hookable_Func& function);
+		//! The new entry's handle is written to 'Handle', if it isn't NULL.
+		uint16_t HookFunction(const c_Hookable_Func& function, c_HookHandle* Handle = NULL);
+		
+		//! Removes the first hooked entry calling 'function'. Returns false if it was not hooked.
+		bool UnhookFunction(c_HookFuncPtr function);
+		
+		//! Removes the entry with the given handle. Returns false if it is not hooked here.
+		bool UnhookHandle(c_HookHandle handle);
+		
+		//! Gets the currently published list of hooked functions, kept alive for as long as the caller holds it.
+		//! Takes HookLock, so it is meant for reports and tools rather than invokes.
+		c_HookSnapshot getHookedFuncs() const;
+		
+		//! Publishes 'New' in place of the current list, and frees retired lists if no invoke can still be using them.
+		//! Must hold HookLock.
+		void PublishList(std::shared_ptr<c_HookList> New);
+		
+		//! Calls a single hooked function, applying CatchHookedErrors. Used by InvokeRaw and the parallel workers.
+		void CallHooked(const c_Hookable_Func& X, size_t index, const void* Data, size_t Count, uint16_t SizeData, c_HookReturn& N);
+		
+		//! Untyped core of every Invoke. Calls each hooked function on 'Count' items of 'SizeData' bytes at 'Data', and tries to handle errors.
+		//! One return per hooked function is written into 'Results', which is resized in place; pass NULL to discard the returns.
+		void InvokeRaw(const void* Data, size_t Count, uint16_t SizeData, std::vector<c_HookReturn>* Results);
+		
+		//! Invokes the hooked functions on a view of 'Count' items without copying them.
+		//! Reusing the same 'Results' vector between calls keeps steady-state dispatch free of heap allocations.
+		template<typename T> void Invoke(const T* Data, size_t Count, std::vector<c_HookReturn>& Results) {
+			check_ptr( Data != NULL || Count == 0 );
+			this->InvokeRaw(static_cast<const void*>(Data), Count, sizeof(T), &Results);
+		}
+		
+		//! Invokes the hooked functions on a view of 'Count' items, for callers that ignore the returns.
+		template<typename T> void InvokeDiscard(const T* Data, size_t Count) {
+			check_ptr( Data != NULL || Count == 0 );
+			this->InvokeRaw(static_cast<const void*>(Data), Count, sizeof(T), NULL);
+		}
 		
 		//! Invokes the functions which are hooked to this hook, with the provided data vector, and tries to handle errors.
-		template<typename T> std::vector<c_HookReturn> Invoke(std::vector<T> Data) {
-			this->InvokeLock.lock();
+		template<typename T> std::vector<c_HookReturn> Invoke(const std::vector<T>& Data) {
 			std::vector<c_HookReturn> returnable;
-			
-			const void* RawPtr = static_cast<void*>(Data.data());
-			assert_safety( RawPtr != NULL );
-			const uint16_t SizeData = sizeof(T); const size_t SizeVector = Data.size();
-			
-			for (uint16_t i = 0; i < HookedFuncs.size(); i++) {
-				c_Hookable_Func& X = this->HookedFuncs.at(i);
-				c_HookReturn N; N.MainData = {}; N.Valid = 0;
-				try {
-					if(X.Func_NoInputs) N = X.Function(0, 0, NULL); else N = X.Function(SizeVector, SizeData, RawPtr);
-				} catch (std::exception* E) {
-					if (this->CatchHookedErrors) {
-						std::string X = E->what();
-						Anoptamin_LogWarn("Caught exception in Hook '" + this->Name + "', Function #" + std::to_string(i));
-						Anoptamin_LogTrace("Error Info: " + X);
-						N.Valid = 0;
-					} else {
-						throw *E;
-					}
-				}
-				returnable.push_back(N);
-			}
-			this->InvokeLock.unlock();
+			this->Invoke<T>(Data.data(), Data.size(), returnable);
 			return returnable;
 		}
+		
+		//! Queues items for the next DrainDeferred (or TakeDeferred) instead of invoking right away. Safe from any thread,
+		//! so workers can raise events while the hooked functions themselves only ever run on the draining thread.
+		template<typename T> void Defer(const T* Data, size_t Count) {
+			static_assert(std::is_trivially_copyable<T>::value, "Deferred hook items are copied bytewise.");
+			check_ptr( Data != NULL || Count == 0 );
+			this->Deferred.push(static_cast<const void*>(Data), Count, sizeof(T));
+		}
+		template<typename T> void Defer(const T& Item) {
+			this->Defer<T>(&Item, 1);
+		}
+		
+		//! Invokes the hooked functions once on everything deferred so far. Meant to be called once per frame by the
+		//! thread which owns the hook. Returns the number of items dispatched.
+		size_t DrainDeferred(std::vector<c_HookReturn>* Results = NULL);
+		
+		//! Moves everything deferred so far onto the end of 'Into', so it can share one Invoke with other items.
+		//! Returns the number of items moved.
+		template<typename T> size_t TakeDeferred(std::vector<T>& Into) {
+			uint16_t SizeData;
+			const std::vector<uint8_t>& Taken = this->Deferred.take(SizeData, sizeof(T));
+			if (Taken.empty()) return 0;
+			const size_t Count = Taken.size() / sizeof(T), Had = Into.size();
+			Into.resize(Had + Count);
+			std::memcpy(static_cast<void*>(Into.data() + Had), Taken.data(), Taken.size());
+			return Count;
+		}
+	};
+	
+	//! Finds a live hook by name and gets the latency percentiles of its function #index. Returns false if there is no such function.
+	bool LIBANOP_FUNC_IMPORT getHookLatency(const std::string& hookName, uint16_t index, c_LatencySummary& out);
+	
+	//! Writes the 'topCount' hooked functions with the highest p99 latency, across every live hook, to the log.
+	void LIBANOP_FUNC_COLD LIBANOP_FUNC_IMPORT logHookLatencyReport(uint16_t topCount = 8);
+	
+	//! Makes hook invokes write the latency report every 'seconds' seconds; zero turns it off (the default).
+	void LIBANOP_FUNC_IMPORT setHookReportInterval(uint32_t seconds);
+	
+	//! Typed front end to c_Function_Hook. Handlers are any callable taking (const EventT* Events, size_t Count) and returning
+	//! either c_HookReturn or nothing, so they can capture their own state (e.g. the window they control) instead of using
+	//! globals, and never cast the input themselves. State lives in the hook list itself (see c_HookCallable).
+	//! Dispatch is still type-erased underneath: Invoke goes through c_Function_Hook::InvokeRaw, and each handler is reached by
+	//! one indirect call to a trampoline instantiated for its type. The handler can be inlined into that trampoline, but the
+	//! call into it is never a direct one, so handlers hooked here can't be inlined into the invoking code.
+	//! Plain c_Hookable_Func entries can still be hooked, so older functions keep working next to typed ones.
+	template<typename EventT> struct c_TypedHook {
+		c_Function_Hook Hook;
+		
+		c_TypedHook(const char* title, bool catchErrs = 0) : Hook(title, catchErrs) {}
+		c_TypedHook() {}
+		
+		//! Wraps a typed handler into an entry which any c_Function_Hook invoked with EventT data accepts.
+		//! It must run after the entries in 'runsAfter' (see c_Hookable_Func::Func_RunsAfterHandles).
+		template<typename F> static c_Hookable_Func makeHookable(F handler, bool independent = 0, const std::vector<c_HookHandle>& runsAfter = {}) {
+			c_Hookable_Func Out;
+			Out.Function = NULL;
+			Out.Func_Independent = independent;
+			Out.Func_RunsAfterHandles = runsAfter;
+			Out.Func_Callable = [handler](const void* Data, size_t Count, uint16_t SizeData) -> c_HookReturn {
+				check_param( SizeData == sizeof(EventT) ); // Invoked with some other element type.
+				const EventT* Events = static_cast<const EventT*>(Data);
+				if constexpr (std::is_void<decltype(handler(Events, Count))>::value) {
+					handler(Events, Count);
+					return c_HookReturn{{}, 0, 1};
+				} else {
+					return handler(Events, Count);
+				}
+			};
+			return Out;
+		}
+		
+		//! Hooks a typed handler, and returns its handle, for UnhookFunction and the 'runsAfter' of later handlers.
+		template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+		c_HookHandle HookFunction(F handler, bool independent = 0, const std::vector<c_HookHandle>& runsAfter = {}) {
+			c_HookHandle Handle;
+			this->Hook.HookFunction(makeHookable(handler, independent, runsAfter), &Handle);
+			return Handle;
+		}
+		//! Hooks an older, untyped function, and returns its handle.
+		c_HookHandle HookFunction(const c_Hookable_Func& function) {
+			c_HookHandle Handle;
+			this->Hook.HookFunction(function, &Handle);
+			return Handle;
+		}
+		//! Removes a handler by the handle HookFunction returned. Returns false if it was not hooked.
+		bool UnhookFunction(c_HookHandle handle) {
+			return this->Hook.UnhookHandle(handle);
+		}
+		
+		void Invoke(const EventT* Events, size_t Count, std::vector<c_HookReturn>& Results) {
+			this->Hook.template Invoke<EventT>(Events, Count, Results);
+		}
+		void InvokeDiscard(const EventT* Events, size_t Count) {
+			this->Hook.template InvokeDiscard<EventT>(Events, Count);
+		}
+		//! Queues an event from any thread; see c_Function_Hook::Defer.
+		void Defer(const EventT& Event) {
+			this->Hook.template Defer<EventT>(Event);
+		}
+		size_t DrainDeferred(std::vector<c_HookReturn>* Results = NULL) {
+			return this->Hook.DrainDeferred(Results);
+		}
 	};
 }} // End Anoptamin::Base
 
@@ -0,0 +1,209 @@
+/********!
+ * @file  draw.hpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Software drawing onto 32-bit SDL surfaces, such as the surface of a
+ *	c_SDLWindow: rect fills, opaque, color-keyed and alpha blended blits.
+ *	Provides includes in:
+ *		Anoptamin::Graphics
+ * 
+ * @note
+ *	Drawing functions are safe to call from several threads at once, as
+ *	long as they do not draw to the same pixels. setDrawISA is not, and
+ *	belongs in setup on the main thread.
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+
+#ifndef anoptamin_Draw
+#define anoptamin_Draw
+
+#include "base.hpp"
+
+namespace Anoptamin { namespace Graphics {
+
+//! The instruction sets the drawing kernels come in. Each draws exactly the same pixels; only the speed differs.
+enum e_Draw_ISA : uint8_t {
+	DRAW_SCALAR,
+	DRAW_SSE2,
+	DRAW_AVX2,
+	DRAW_ISA_COUNT
+};
+
+//! Gets the instruction set drawing currently uses. It starts as the best one the CPU supports.
+e_Draw_ISA getDrawISA() noexcept;
+//! Gets the best instruction set the CPU (and this build) supports.
+e_Draw_ISA getBestDrawISA() noexcept;
+//! Makes drawing use a particular instruction set, e.g. to compare them. It must be supported.
+void setDrawISA(e_Draw_ISA isa);
+//! Gets the name of an instruction set, for logging.
+const char* getDrawISAName(e_Draw_ISA isa) noexcept;
+
+//! A rectangle of 32-bit pixels: a whole surface, or a part of one. Views do not own their pixels.
+//! Every drawing function takes views in a format with alpha (if any) in the top byte, which covers SDL's ARGB8888,
+//! XRGB8888 (RGB888) and ABGR8888; window surfaces are almost always one of these.
+struct c_PixelView {
+	uint32_t* Pixels = NULL; // Top-left pixel.
+	int32_t Width = 0, Height = 0;
+	int32_t Pitch = 0; // Pixels from the start of one row to the next.
+	
+	//! Views a whole surface. The surface must be 32 bits per pixel, and locked first if SDL_MUSTLOCK says so.
+	static c_PixelView of(SDL_Surface* surface);
+	//! Views the part of this view inside 'rect' (relative to this view), clipped to it.
+	c_PixelView sub(const SDL_Rect& rect) const noexcept;
+	
+	uint32_t* row(int32_t y) const noexcept { return Pixels + size_t(y) * size_t(Pitch); }
+	bool empty() const noexcept { return Width <= 0 || Height <= 0; }
+	SDL_Rect bounds() const noexcept { return {0, 0, Width, Height}; }
+};
+
+//! Fills 'rect' (or the whole view, if NULL) with 'color', clipped to the view.
+LIBANOP_FUNC_HOT void fillRect(const c_PixelView& dst, const SDL_Rect* rect, uint32_t color);
+//! Fills the whole view with 'color'.
+void clear(const c_PixelView& dst, uint32_t color);
+
+//! Copies 'srcRect' of 'src' (or all of it, if NULL) to 'dst' with its top-left corner at x, y, clipped to both views.
+//! The views must not overlap.
+LIBANOP_FUNC_HOT void blit(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y);
+//! Like blit, but skips source pixels whose color (ignoring alpha) is 'key'.
+LIBANOP_FUNC_HOT void blitKeyed(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y,
+	uint32_t key);
+//! Like blit, but blends each source pixel over the destination by its alpha, the same as SDL_BLENDMODE_BLEND:
+//! color = src * a + dst * (1 - a), alpha = a + dstAlpha * (1 - a). Rounds to the nearest value.
+LIBANOP_FUNC_HOT void blitBlended(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y);
+
+//! How scale() samples the source.
+enum e_Scale_Filter : uint8_t {
+	SCALE_NEAREST, // Each pixel takes the source pixel its center falls in. Blocky, and the cheapest.
+	SCALE_BILINEAR // Each pixel blends the four source pixels around its center. Smooth.
+};
+
+//! Stretches the whole of 'src' over the whole of 'dst'. Pixel centers line up, so scaling by a whole number keeps the
+//! image centered, and each channel (alpha included) is interpolated alone. The views must not overlap.
+LIBANOP_FUNC_HOT void scale(const c_PixelView& src, const c_PixelView& dst, e_Scale_Filter filter);
+
+//! A set of rectangles which have changed, e.g. since the last present. Each rectangle added is merged with any it is
+//! near, whenever their bounding box would cover no more than 'mergeCost' pixels which are in neither, so the set stays
+//! short without covering much more than what changed. Past 'maxRects', the two cheapest to merge are merged.
+//! Everything is clipped to the bounds; once the set covers them, it collapses to a single full rectangle.
+class c_DirtyRegion {
+	std::vector<SDL_Rect> m_rects;
+	SDL_Rect m_bounds = {0, 0, 0, 0};
+	uint64_t m_area = 0; // Sum of the rectangles' areas.
+	uint32_t m_mergeCost = 4096;
+	uint16_t m_maxRects = 32;
+	bool m_full = 0;
+	
+	void collapse();
+public:
+	//! Sets the area rectangles are clipped to, and marks all of it.
+	void setBounds(int32_t width, int32_t height);
+	//! Sets how many wasted pixels a merge may cost, and how many rectangles to keep at most.
+	void setMergeCost(uint32_t pixels, uint16_t maxRects = 32);
+	
+	//! Adds a rectangle.
+	LIBANOP_FUNC_HOT void add(const SDL_Rect& rect);
+	//! Marks the whole of the bounds.
+	void addAll() noexcept;
+	//! Empties the set.
+	void clear() noexcept;
+	
+	bool empty() const noexcept { return m_rects.empty(); }
+	//! Whether the set covers the whole bounds.
+	bool full() const noexcept { return m_full; }
+	//! Gets the rectangles; they may overlap a little where merging them would have cost too much.
+	const std::vector<SDL_Rect>& getRects() const noexcept { return m_rects; }
+	//! Gets the sum of the rectangles' areas, in pixels.
+	uint64_t getArea() const noexcept { return m_area; }
+	//! Gets the area as a fraction of the bounds.
+	double getCoverage() const noexcept;
+	const SDL_Rect& getBounds() const noexcept { return m_bounds; }
+};
+
+//! Draws a frame's worth of commands in parallel. Commands are recorded first, then flush() splits the target into
+//! tiles of a cache-friendly size, bins each command into the tiles it touches, and has the worker pool draw whole tiles
+//! at once, each thread taking the next undrawn tile until none are left. Every tile applies its commands in the order
+//! they were recorded, so the result is the same as drawing them one after another.
+//! Recording and flushing belong on one thread; source pixels must stay valid until the flush.
+class c_TiledRenderer {
+	enum e_Command : uint8_t {
+		COMMAND_FILL,
+		COMMAND_BLIT,
+		COMMAND_BLIT_KEYED,
+		COMMAND_BLIT_BLENDED
+	};
+	struct c_Command {
+		e_Command Kind;
+		SDL_Rect Area; // Where it draws on the target, before clipping.
+		c_PixelView Source;
+		SDL_Rect SourceRect;
+		uint32_t Color; // Fill color, or color key.
+	};
+	
+	std::vector<c_Command> m_commands;
+	int32_t m_tileWidth, m_tileHeight;
+	uint16_t m_threads = 0;
+	Base::c_WorkerPool* mp_pool;
+	
+	// State of a flush in progress.
+	c_PixelView m_target;
+	int32_t m_tilesAcross = 0;
+	uint32_t m_tileCount = 0;
+	std::vector<uint32_t> m_binOffsets, m_bins; // The commands of tile i are m_bins[m_binOffsets[i]] up to m_binOffsets[i + 1].
+	std::atomic<uint32_t> m_nextTile{0};
+	std::atomic<uint16_t> m_helpersLeft{0};
+	
+	void record(const c_Command& command);
+	LIBANOP_FUNC_HOT void drawTile(uint32_t tile);
+	//! Draws tiles until none are left.
+	void drawTiles();
+	static void helperTask(void* renderer);
+public:
+	//! Makes a renderer drawing with 'pool' (or the shared pool, if NULL). The default tiles are 32 KiB.
+	c_TiledRenderer(int32_t tileWidth = 128, int32_t tileHeight = 64, Base::c_WorkerPool* pool = NULL);
+	
+	//! Sets how many threads draw, the calling one included, or zero for all of the pool's and the caller.
+	void setThreads(uint16_t threads) noexcept { m_threads = threads; }
+	//! Gets how many threads a flush will draw with.
+	uint16_t getThreads() const noexcept;
+	//! Gets how many commands are recorded.
+	size_t getCommandCount() const noexcept { return m_commands.size(); }
+	
+	//! Records drawing commands, which work as the functions of the same name.
+	void fillRect(const SDL_Rect* rect, uint32_t color);
+	void clear(uint32_t color);
+	void blit(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y);
+	void blitKeyed(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y, uint32_t key);
+	void blitBlended(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y);
+	//! Drops the recorded commands without drawing them.
+	void discard() noexcept { m_commands.clear(); }
+	
+	//! Draws every recorded command to 'target', waits until it is done, and drops the commands. If 'dirty' is given, the
+	//! area each command drew is added to it.
+	void flush(const c_PixelView& target, c_DirtyRegion* dirty = NULL);
+};
+
+}} // End Anoptamin::Graphics
+
+#endif
@@ -0,0 +1,185 @@
+/********!
+ * @file  frame.hpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Owns the main loop of a window: polling, fixed-rate updates, rendering,
+ *	presenting, pacing to a target frame rate, and scaling the render
+ *	resolution to hold that rate.
+ *	Provides includes in:
+ *		Anoptamin::Base
+ * 
+ * @note
+ *	Like the rest of the SDL wrappers, none of this is thread-safe,
+ *	and should be managed from the main thread.
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+
+#ifndef anoptamin_Frame
+#define anoptamin_Frame
+
+#include "sdl.hpp"
+#include <functional>
+
+namespace Anoptamin { namespace Base {
+
+//! The parts of a frame c_FrameScheduler times separately.
+enum e_Frame_Phase : uint8_t {
+	PHASE_POLL, // Pumping and sorting events, not counting the hooks.
+	PHASE_HOOKS, // The window's event hooks.
+	PHASE_UPDATE, // Every fixed tick run this frame.
+	PHASE_RENDER,
+	PHASE_PRESENT,
+	PHASE_SLEEP, // Pacing: sleeping and spinning until the next frame is due.
+	PHASE_COUNT
+};
+
+//! What happened in one frame.
+struct c_FrameTiming {
+	uint64_t Frame = 0; // Frame number, from zero.
+	uint64_t PhaseNanos[PHASE_COUNT] = {}; // Time spent in each phase.
+	uint64_t FrameNanos = 0; // Start of this frame to the start of the next (pacing included).
+	uint16_t Ticks = 0; // Fixed ticks run.
+	bool Idle = 0; // The window was hidden or minimized, so the frame only polled.
+	double Alpha = 0; // The interpolation alpha passed to the render function.
+};
+
+//! Picks a render scale (see c_SDLWindow::setRenderScale) which keeps each frame's work inside the frame time budget.
+//! It follows a moving average of the work, and takes that to go with the number of pixels drawn, the square of the
+//! scale. Once the average passes 90% of the budget it scales down at once, to bring it to 80%; below 65% it scales back
+//! up, a small step at a time. After each change it lets the average settle (longer after going up, so it does not
+//! bounce), and scales are rounded down to 1/32 so the backbuffer is not resized over noise.
+class c_ResolutionController {
+	uint64_t m_budgetNanos;
+	float m_scale, m_minScale, m_maxScale;
+	double m_average = 0; // Moving average of the work per frame, in nanoseconds; zero before the first frame.
+	uint16_t m_settle = 0; // Frames left before the scale may change again.
+public:
+	//! Starts at 'maxScale', with a budget of one frame at 'targetFPS'.
+	c_ResolutionController(double targetFPS = 60, float minScale = 0.5f, float maxScale = 1.0f);
+	
+	void setTargetFPS(double fps);
+	//! Sets the range of scales to pick from, above 0 and up to 1. The scale is clamped into it.
+	void setLimits(float minScale, float maxScale);
+	//! Takes how long one frame's work took. Returns true if the scale changed.
+	bool update(uint64_t workNanos);
+	//! Forgets the frame times, keeping the scale.
+	void reset() noexcept;
+	
+	float getScale() const noexcept { return m_scale; }
+	//! Gets the moving average of the work per frame, in nanoseconds.
+	double getAverageNanos() const noexcept { return m_average; }
+};
+
+//! Runs the main loop of a c_SDLWindow. Each frame it polls the window (running its hooks), runs the update function
+//! zero or more times at a fixed tick rate, renders once with how far it is between the last tick and the next, presents,
+//! then waits out the rest of the frame.
+//! Time is kept in nanoseconds off clockNanos(). The accumulator is capped at a few ticks, so a stall (a debugger, a
+//! dragged window) drops time instead of running a burst of updates to catch up.
+//! Pacing sleeps for most of the wait and spins on the clock for the last stretch, which is sized from how far the OS
+//! has been overshooting its sleeps, so frames start on time without spinning the whole frame away.
+//! While the window is hidden or minimized, frames skip updating and rendering, and block in waitEvents instead.
+class c_FrameScheduler {
+public:
+	//! Runs one fixed tick; 'dt' is the tick length in seconds.
+	typedef std::function<void(double dt)> t_UpdateFunc;
+	//! Draws a frame; 'alpha' (0 to 1) is how far the current time is past the last tick, towards the next.
+	typedef std::function<void(double alpha)> t_RenderFunc;
+	//! Shows a drawn frame. Defaults to refreshing the window surface, or to presentRendered while the window has a render
+	//! thread; a slow render thread then costs frames, not polls.
+	typedef std::function<void()> t_PresentFunc;
+private:
+	c_SDLWindow* mp_window;
+	t_UpdateFunc m_update;
+	t_RenderFunc m_render;
+	t_PresentFunc m_present;
+	
+	uint64_t m_tickNanos; // Fixed tick length.
+	uint64_t m_frameNanos = 0; // Target frame length, or zero to run unpaced.
+	uint64_t m_accumulator = 0;
+	uint16_t m_maxTicks = 5; // Most ticks run in one frame.
+	
+	uint64_t m_frameStart = 0; // When the current frame started, or zero before the first.
+	uint64_t m_nextFrame = 0; // When the next frame is due.
+	uint64_t m_spinNanos = 1000000; // How long before a deadline to stop sleeping and spin.
+	bool m_running = 0;
+	
+	uint64_t m_frameCount = 0;
+	c_FrameTiming m_last;
+	c_LatencyHistogram m_phaseLatency[PHASE_COUNT], m_frameLatency;
+	
+	c_ResolutionController m_resolution;
+	bool m_dynamicResolution = 0;
+	
+	//! Waits until the next frame is due.
+	void pace();
+public:
+	//! Schedules 'window' (which must outlive the scheduler), ticking at 'tickRate' times per second, unpaced.
+	c_FrameScheduler(c_SDLWindow* window, double tickRate = 60.0);
+	
+	void setUpdate(t_UpdateFunc func);
+	void setRender(t_RenderFunc func);
+	void setPresent(t_PresentFunc func);
+	
+	//! Sets how many fixed ticks run per second.
+	void setTickRate(double tickRate);
+	double getTickRate() const noexcept;
+	//! Sets the frame rate to pace to, or zero to run frames back to back.
+	void setTargetFPS(double fps);
+	double getTargetFPS() const noexcept;
+	//! Paces to the refresh rate of the display the window is on (60 if SDL can not tell).
+	void syncToDisplay();
+	//! Sets the most ticks one frame may run before the rest of the accumulated time is dropped.
+	void setMaxTicksPerFrame(uint16_t count);
+	//! Turns dynamic resolution on or off. While on, every frame's update, render and present time (or with a render
+	//! thread, its render time) goes to a c_ResolutionController, which sets the window's render scale between
+	//! 'minScale' and 'maxScale' to hold the target frame rate (60 if unpaced). Turning it off puts the scale back to 1.
+	void setDynamicResolution(bool enabled, float minScale = 0.5f, float maxScale = 1.0f);
+	bool getDynamicResolution() const noexcept { return m_dynamicResolution; }
+	const c_ResolutionController& getResolutionController() const noexcept { return m_resolution; }
+	
+	//! Runs one frame. Returns false once the window has closed.
+	LIBANOP_FUNC_HOT bool frame();
+	//! Runs frames until the window closes, stop() is called, or 'maxFrames' frames have run (if not zero).
+	void run(uint64_t maxFrames = 0);
+	//! Makes run() return after the current frame.
+	void stop() noexcept { m_running = 0; }
+	
+	//! Gets the number of frames run so far.
+	uint64_t getFrameCount() const noexcept { return m_frameCount; }
+	//! Gets the timing of the last frame.
+	const c_FrameTiming& getLastFrame() const noexcept { return m_last; }
+	//! Gets the spread of one phase's time per frame, in nanoseconds.
+	c_LatencySummary getPhaseSummary(e_Frame_Phase phase) const;
+	//! Gets the spread of whole frame times, in nanoseconds.
+	c_LatencySummary getFrameSummary() const;
+	//! Clears the phase and frame statistics.
+	void resetTiming();
+	//! Logs the per-phase statistics.
+	LIBANOP_FUNC_COLD void logTimingReport() const;
+};
+
+}} // End Anoptamin::Base
+
+#endif
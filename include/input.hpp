@@ -0,0 +1,152 @@
+/********!
+ * @file  input.hpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Maps raw keyboard and mouse input onto named game actions.
+ *	Provides includes in:
+ *		Anoptamin::Base
+ * 
+ * @note
+ *	Like the rest of the SDL wrappers, none of this is thread-safe,
+ *	and should be managed from the main thread.
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+
+#ifndef anoptamin_Input
+#define anoptamin_Input
+
+#include "sdl.hpp"
+
+namespace Anoptamin { namespace Base {
+
+//! Identifies what kind of input a binding listens to.
+enum e_Input_Source : uint8_t {
+	SOURCE_KEY,
+	SOURCE_MOUSE_BUTTON
+};
+
+//! Bits of an action's per-frame state.
+enum e_Action_State : uint8_t {
+	ACTION_HELD = 1, // At least one of its bindings is down.
+	ACTION_PRESSED = 2, // It went from released to held this frame.
+	ACTION_RELEASED = 4 // It went from held to released this frame.
+};
+
+//! One input an action is bound to: a key or mouse button, optionally as a chord with up to three keys which must
+//! already be held when it goes down (e.g. LCTRL + S).
+struct c_InputBinding {
+	static constexpr uint8_t MaxChord = 3;
+	
+	e_Input_Source Source = SOURCE_KEY;
+	uint16_t Code = 0; // SDL_Scancode for keys, SDL_BUTTON_* for mouse buttons.
+	SDL_Scancode Chord[MaxChord] = {SDL_SCANCODE_UNKNOWN, SDL_SCANCODE_UNKNOWN, SDL_SCANCODE_UNKNOWN};
+	
+	static c_InputBinding key(SDL_Scancode what, std::initializer_list<SDL_Scancode> chord = {});
+	static c_InputBinding mouseButton(uint8_t button, std::initializer_list<SDL_Scancode> chord = {});
+	
+	bool operator==(const c_InputBinding& b) const noexcept;
+};
+	
+//! Turns the event stream of a c_SDLWindow into a dense array of action states, one byte (of e_Action_State) per action.
+//! Bindings live in flat tables indexed by scancode or mouse button, each entry heading a short chain of the bindings on
+//! that input, so an event costs the same however many bindings exist elsewhere. Binding and unbinding edit the chains
+//! in place, so actions can be rebound at runtime without rebuilding anything.
+//! When chords share a trigger, only the matching bindings with the most chord keys fire (LCTRL + S suppresses S).
+class c_ActionMap {
+	static constexpr uint16_t None = UINT16_MAX;
+	static constexpr uint8_t MouseButtons = 8;
+	
+	struct c_Slot {
+		c_InputBinding Binding;
+		uint16_t Action;
+		uint16_t Next; // Next binding on the same input, or None. Doubles as the free list link.
+		uint8_t ChordSize;
+		bool Active; // Its input went down (with the chord held) and has not come up yet.
+	};
+	
+	std::vector<std::string> m_names;
+	std::vector<uint8_t> m_states;
+	std::vector<uint16_t> m_activeCount; // Active bindings per action.
+	
+	uint16_t m_keyHead[SDL_NUM_SCANCODES];
+	uint16_t m_buttonHead[MouseButtons];
+	std::vector<c_Slot> m_slots;
+	uint16_t m_freeSlot = None;
+	
+	c_KeySet m_keysHeld; // Kept from the events themselves, for testing chords.
+	
+	uint16_t& headOf(e_Input_Source source, uint16_t code);
+	void activate(c_Slot& slot);
+	void deactivate(c_Slot& slot);
+	//! Handles an input going down or up.
+	LIBANOP_FUNC_HOT void inputDown(e_Input_Source source, uint16_t code);
+	LIBANOP_FUNC_HOT void inputUp(e_Input_Source source, uint16_t code);
+public:
+	c_ActionMap();
+	
+	//! Registers a new action, and returns its ID (its index in getStates()). Names must be unique.
+	uint16_t addAction(const std::string& name);
+	//! Gets the ID of a named action. Throws if there is no such action.
+	uint16_t findAction(const std::string& name) const;
+	//! Gets the name of an action.
+	const std::string& getActionName(uint16_t action) const;
+	//! Gets the number of actions.
+	uint16_t getActionCount() const noexcept { return uint16_t(m_names.size()); }
+	
+	//! Binds an input to an action. Any number of inputs can drive one action, and one input can drive several actions.
+	void bind(uint16_t action, const c_InputBinding& binding);
+	//! Removes a binding from an action. Returns false if it was not bound.
+	bool unbind(uint16_t action, const c_InputBinding& binding);
+	//! Removes every binding of an action.
+	void unbindAll(uint16_t action);
+	//! Unbinds an action, then binds it to 'binding' alone.
+	void rebind(uint16_t action, const c_InputBinding& binding);
+	
+	//! Starts a new frame, clearing the ACTION_PRESSED and ACTION_RELEASED edges.
+	void beginFrame() noexcept;
+	//! Applies a batch of polled events; anything other than key and mouse button events is skipped.
+	LIBANOP_FUNC_HOT void feed(const SDL_Event* events, size_t count);
+	//! Starts a new frame and applies one poll's events, e.g. update(Window.pollEvents()).
+	void update(const c_SDLEventView& events) {
+		this->beginFrame();
+		this->feed(events.Events, events.Count);
+	}
+	void update(const std::vector<SDL_Event>& events) {
+		this->beginFrame();
+		this->feed(events.data(), events.size());
+	}
+	//! Releases every held action (e.g. when the window loses focus, and will not see the key up events).
+	void releaseAll() noexcept;
+	
+	//! Gets the e_Action_State bits of every action, indexed by action ID.
+	const uint8_t* getStates() const noexcept { return m_states.data(); }
+	bool held(uint16_t action) const noexcept { return m_states[action] & ACTION_HELD; }
+	bool pressed(uint16_t action) const noexcept { return m_states[action] & ACTION_PRESSED; }
+	bool released(uint16_t action) const noexcept { return m_states[action] & ACTION_RELEASED; }
+};
+
+}} // End Anoptamin::Base
+
+#endif
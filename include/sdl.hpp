@@ -15,8 +15,10 @@
  * 
  * @note
  *	None of the classes implemented here are thread-safe. All should
- *	be managed from the main thread.
- *
+ *	be managed from the main thread; the only exceptions are the
+ *	c_SDLWindow::defer*Event functions, which any thread may call, and
+ *	the function given to startRenderThread, which runs on its own.
+ * 
  * @copyright
  * 	Copyright (C) 2023 Evan Clegern
  * 
@@ -39,6 +41,7 @@
 #define anoptamin_SDL
 
 #include "base.hpp"
+#include "draw.hpp"
 
 #include <SDL2/SDL_clipboard.h>
 #include <SDL2/SDL_keyboard.h>
@@ -52,6 +55,14 @@
 #include <SDL2/SDL_power.h>
 #include <SDL2/SDL_timer.h>
 
+#include <bitset>
+#include <functional>
+#include <initializer_list>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
 
 namespace Anoptamin { namespace Base {
 
@@ -64,10 +75,321 @@ enum e_SDLWindow_Type : uint8_t {
 	TYPE_POPUP
 };
 
+//! Event subtypes a filtered hook can ask for; see c_SDLEventFilter::Subtypes.
+enum e_SDLEvent_Subtype : uint8_t {
+	SUBTYPE_PRESS = 1, // Key or mouse button went down (not a key repeat).
+	SUBTYPE_RELEASE = 2, // Key or mouse button came up.
+	SUBTYPE_REPEAT = 4, // Key held down long enough to repeat.
+	SUBTYPE_SCROLL_VERTICAL = 8,
+	SUBTYPE_SCROLL_HORIZONTAL = 16
+};
+
+//! Declares which events a function hooked through the c_SDLWindow::addHook_* functions wants to see.
+//! Any field left empty matches everything, so a default filter sees the same events as an unfiltered hook.
+struct c_SDLEventFilter {
+	std::bitset<SDL_NUM_SCANCODES> Scancodes; // Keyboard hooks only.
+	uint8_t MouseButtons = 0; // Mask of SDL_BUTTON(x). Button hooks: the button. Motion hooks: any of these must be held.
+	uint8_t Subtypes = 0; // Mask of e_SDLEvent_Subtype.
+	
+	//! Filter for keyboard hooks which only care about a few keys.
+	static c_SDLEventFilter keys(std::initializer_list<SDL_Scancode> scancodes, uint8_t subtypes = 0) {
+		c_SDLEventFilter Out;
+		for (SDL_Scancode X : scancodes) Out.Scancodes.set(X);
+		Out.Subtypes = subtypes;
+		return Out;
+	}
+	//! Filter for mouse button or motion hooks which only care about some buttons.
+	static c_SDLEventFilter buttons(uint8_t buttonMask, uint8_t subtypes = 0) {
+		c_SDLEventFilter Out;
+		Out.MouseButtons = buttonMask;
+		Out.Subtypes = subtypes;
+		return Out;
+	}
+};
+
+//! Identifies which events a c_SDLEventRouter routes, and so how it keys them.
+enum e_SDLRoute_Kind : uint8_t {
+	ROUTE_KEYBOARD,
+	ROUTE_MOUSE_BUTTON,
+	ROUTE_MOUSE_MOTION,
+	ROUTE_MOUSE_SCROLL
+};
+
+//! Hands the events of one category to the functions hooked with a filter, each getting only the events it matches.
+//! Every event reduces to a small route key (e.g. subtype and scancode), and a table compiled whenever a function is
+//! added lists exactly the functions which want each key, so routing an event costs nothing for the functions that
+//! do not match it. Each filtered function sits in its own c_Function_Hook, with its own batch buffer reused every poll.
+class c_SDLEventRouter {
+	struct c_Route {
+		std::unique_ptr<c_Function_Hook> Hook;
+		c_SDLEventFilter Filter;
+		std::vector<SDL_Event> Batch;
+	};
+	e_SDLRoute_Kind m_kind;
+	std::vector<c_Route> m_routes;
+	std::vector<uint32_t> m_offsets; // m_targets[m_offsets[key] .. m_offsets[key + 1]] want 'key'.
+	std::vector<uint16_t> m_targets;
+	std::vector<uint16_t> m_pending; // Routes with a non-empty batch.
+	
+	//! Rebuilds m_offsets and m_targets.
+	void compile();
+public:
+	c_SDLEventRouter(e_SDLRoute_Kind kind);
+	//! Adds a filtered function, and returns how many this router now has.
+	uint16_t add(const c_Hookable_Func& function, const c_SDLEventFilter& filter, const std::string& name);
+	//! Queues an event for every function whose filter matches it.
+	LIBANOP_FUNC_HOT void route(const SDL_Event& event);
+	//! Invokes each function which got events since the last dispatch, once, on its batch.
+	void dispatch();
+	//! True if no functions have been added.
+	bool empty() const noexcept { return m_routes.empty(); }
+};
+
+//! Fixed set of scancodes, one bit each, used for the per-poll keyboard snapshots. Tests are a single bit test, and the
+//! whole-set operations work 128 bits at a time with SSE2 (falling back to 64-bit words without it).
+struct alignas(64) c_KeySet {
+	static constexpr uint16_t Bits = 512;
+	uint64_t Words[Bits / 64] = {};
+	
+	bool test(SDL_Scancode what) const noexcept {
+		return (uint32_t(what) < Bits) && ((Words[what >> 6] >> (what & 63)) & 1);
+	}
+	void set(SDL_Scancode what) noexcept {
+		if (uint32_t(what) < Bits) Words[what >> 6] |= uint64_t(1) << (what & 63);
+	}
+	void reset(SDL_Scancode what) noexcept {
+		if (uint32_t(what) < Bits) Words[what >> 6] &= ~(uint64_t(1) << (what & 63));
+	}
+	void clear() noexcept {
+		for (uint64_t& W : Words) W = 0;
+	}
+	bool any() const noexcept {
+		uint64_t All = 0;
+		for (uint64_t W : Words) All |= W;
+		return All != 0;
+	}
+	uint16_t count() const noexcept {
+		uint16_t Out = 0;
+		for (uint64_t W : Words) Out += __builtin_popcountll(W);
+		return Out;
+	}
+	
+	//! Rebuilds the set from an SDL_GetKeyboardState array of 'count' bytes (non-zero meaning held).
+	void load(const uint8_t* states, int32_t count) noexcept;
+	
+	//! Compares two snapshots: 'pressed' gets the keys held in 'now' but not 'before', 'released' the reverse.
+	static void edges(const c_KeySet& now, const c_KeySet& before, c_KeySet& pressed, c_KeySet& released) noexcept {
+	#if defined(__SSE2__)
+		for (uint8_t i = 0; i < Bits / 64; i += 2) {
+			const __m128i Now = _mm_load_si128((const __m128i*)(now.Words + i));
+			const __m128i Before = _mm_load_si128((const __m128i*)(before.Words + i));
+			const __m128i Changed = _mm_xor_si128(Now, Before);
+			_mm_store_si128((__m128i*)(pressed.Words + i), _mm_and_si128(Changed, Now));
+			_mm_store_si128((__m128i*)(released.Words + i), _mm_and_si128(Changed, Before));
+		}
+	#else
+		for (uint8_t i = 0; i < Bits / 64; i++) {
+			const uint64_t Changed = now.Words[i] ^ before.Words[i];
+			pressed.Words[i] = Changed & now.Words[i];
+			released.Words[i] = Changed & before.Words[i];
+		}
+	#endif
+	}
+	
+	//! Walks the scancodes in the set, lowest first, skipping clear bits a word at a time.
+	class c_Iterator {
+		const uint64_t* m_words;
+		uint8_t m_index;
+		uint64_t m_rest;
+		
+		void skipEmpty() noexcept {
+			while (m_rest == 0 && m_index < Bits / 64) {
+				if (++m_index < Bits / 64) m_rest = m_words[m_index];
+			}
+		}
+	public:
+		c_Iterator(const uint64_t* words, uint8_t index) : m_words(words), m_index(index), m_rest(index < Bits / 64 ? words[index] : 0) {
+			this->skipEmpty();
+		}
+		SDL_Scancode operator*() const noexcept {
+			return SDL_Scancode(m_index * 64 + __builtin_ctzll(m_rest));
+		}
+		c_Iterator& operator++() noexcept {
+			m_rest &= m_rest - 1;
+			this->skipEmpty();
+			return *this;
+		}
+		bool operator!=(const c_Iterator& b) const noexcept {
+			return m_index != b.m_index || m_rest != b.m_rest;
+		}
+	};
+	c_Iterator begin() const noexcept { return c_Iterator(Words, 0); }
+	c_Iterator end() const noexcept { return c_Iterator(Words, Bits / 64); }
+};
+
+//! Non-owning view of the events a window polled, which stays valid until that window polls again.
+struct c_SDLEventView {
+	const SDL_Event* Events = NULL;
+	size_t Count = 0;
+	
+	const SDL_Event* begin() const noexcept { return Events; }
+	const SDL_Event* end() const noexcept { return Events + Count; }
+	size_t size() const noexcept { return Count; }
+	bool empty() const noexcept { return Count == 0; }
+	const SDL_Event& operator[](size_t i) const noexcept { return Events[i]; }
+};
+
+//! Replays an input recording made with c_SDLWindow::startInputRecording, by pushing its events back onto SDL's queue
+//! with SDL_PushEvent, so the whole input path (polling, hooks, action maps) runs as if a user were there. The file is
+//! memory-mapped, and events are pushed a recorded poll at a time: on the original schedule scaled by 'speed', or with a
+//! speed of zero, one recorded poll per pump() regardless of time, which makes runs repeatable frame for frame.
+//! With useDummyVideoDriver(), this works headless.
+class c_InputReplay {
+	const uint8_t* mp_data = NULL;
+	size_t m_size = 0, m_offset = 0;
+	std::vector<uint8_t> m_loaded; // Holds the file where it cannot be mapped.
+	bool m_mapped = 0;
+	double m_speed;
+	uint64_t m_startNanos = 0;
+	uint32_t m_windowID = 0;
+	size_t m_polls = 0, m_events = 0;
+	
+	//! Pushes the next recorded poll.
+	void pushPoll();
+public:
+	//! Opens a recording. A 'speed' of 2 plays it twice as fast; zero plays one recorded poll per pump().
+	c_InputReplay(const std::string& path, double speed = 1.0);
+	~c_InputReplay();
+	c_InputReplay(const c_InputReplay&) = delete;
+	c_InputReplay& operator=(const c_InputReplay&) = delete;
+	
+	//! Rewrites the window ID of window events to 'windowID', for replays into a window other than the recorded one.
+	void setWindowID(uint32_t windowID) noexcept;
+	//! Pushes every recorded poll which is due. Call once per frame, before polling; returns the events pushed.
+	size_t pump();
+	//! True once every recorded poll has been pushed.
+	const bool finished() const noexcept;
+	//! Starts over from the first recorded poll.
+	void restart() noexcept;
+	//! Gets the number of polls and events pushed so far.
+	const size_t getPollsPlayed() const noexcept;
+	const size_t getEventsPlayed() const noexcept;
+	
+	//! Asks SDL for its 'dummy' video driver, which needs no display. Call before SDL_Init.
+	static void useDummyVideoDriver();
+};
+
+//! What c_SDLWindow::waitEvents has been doing, to check that it saves CPU while idle without adding input latency.
+struct c_SDLWaitStats {
+	uint64_t Waits = 0; // Calls which blocked at all.
+	uint64_t EventWakeups = 0; // Woken early by an event.
+	uint64_t TimeoutWakeups = 0; // Woken by the frame deadline or idle timeout.
+	uint64_t IdleWaits = 0; // Waits made while hidden, minimized or unfocused.
+	uint64_t BlockedNanos = 0; // Total time spent blocked.
+	c_LatencySummary EventLatency; // From SDL queuing an event to the poll which took it (millisecond resolution).
+	c_LatencySummary Oversleep; // How late timed-out waits woke, against what they asked for.
+};
+
+//! The kinds of input event the input latency tracer follows separately.
+enum e_SDLTrace_Category : uint8_t {
+	TRACE_KEYBOARD,
+	TRACE_MOUSE_BUTTON,
+	TRACE_MOUSE_MOTION,
+	TRACE_MOUSE_SCROLL,
+	TRACE_COUNT
+};
+
+//! How long one category of input events took to get through the pipeline, each measured from when SDL queued the event.
+//! SDL stamps events in whole milliseconds, so these are accurate to about half a millisecond.
+struct c_SDLInputLatency {
+	c_LatencySummary Polled; // Until the poll which took it from SDL's queue.
+	c_LatencySummary Dispatched; // Until the window's hooks had run on it.
+	c_LatencySummary Presented; // Until the next present (refreshWindowSurface or markPresented) after that.
+};
+
+//! How c_SDLWindow::refreshWindowSurface has been presenting.
+struct c_SDLPresentStats {
+	uint64_t Full = 0; // Presents of the whole surface.
+	uint64_t Partial = 0; // Presents of just the dirty rectangles.
+	uint64_t Skipped = 0; // Presents with nothing dirty, which pushed nothing.
+	uint64_t Pixels = 0; // Pixels pushed, over all presents.
+};
+
+//! Draws one frame on a window's render thread (see c_SDLWindow::startRenderThread), into 'target', a back buffer the
+//! size of the window's render target (see c_SDLWindow::setRenderScale). 'frame' counts the frames the thread has drawn. It runs alongside the main thread, so it must
+//! only read game state that is safe to read from another thread, such as a snapshot the update publishes.
+typedef std::function<void(const Graphics::c_PixelView& target, uint64_t frame)> t_RenderThreadFunc;
+
+//! What a window's render thread has been doing, to see how far rendering lags behind polling.
+struct c_SDLRenderStats {
+	uint64_t Rendered = 0; // Frames the render thread finished.
+	uint64_t Presented = 0; // Frames presentRendered put on screen.
+	uint64_t Dropped = 0; // Finished frames replaced by a newer one before being shown (triple buffering only).
+	uint64_t Stale = 0; // Calls to presentRendered with no new frame, which showed nothing.
+	c_LatencySummary RenderTime; // How long the render function took.
+	uint64_t LastRenderNanos = 0; // How long it took for the last frame finished.
+	c_LatencySummary FrameAge; // From a frame being finished to it being shown.
+};
+
+class c_SDLWindow;
+struct c_InputTracer;
+struct c_RenderThread;
+
+//! Routes SDL's single event queue to every open c_SDLWindow. Once per frame, dispatch() pumps SDL once, drains the
+//! queue in blocks, and hands each event to the window its windowID names, found through a small open-addressed hash
+//! table; each window then runs its hooks on its own events exactly as pollEvents() would. Events which belong to no
+//! window (or to one this process does not know) go to the global hook instead, and SDL_QUIT goes to both the global
+//! hook and every window. The cost per event stays flat however many windows are open.
+//! With more than one window, use this instead of c_SDLWindow::pollEvents, which would take the other windows' events.
+class c_EventDispatcher {
+	struct c_Slot {
+		uint32_t WindowID = 0; // Zero marks an empty slot; SDL never hands out window ID zero.
+		c_SDLWindow* Window = NULL;
+	};
+	std::vector<c_SDLWindow*> m_windows;
+	std::vector<c_SDLWindow*> m_dispatching; // The windows the current dispatch() started with.
+	std::vector<c_Slot> m_table;
+	uint32_t m_tableMask = 0;
+	uint8_t m_tableShift = 32;
+	
+	std::vector<SDL_Event> m_events, m_global;
+	c_Function_Hook m_hookGlobal;
+	
+	c_EventDispatcher();
+	//! Rebuilds the hash table from m_windows.
+	void rebuild();
+	LIBANOP_FUNC_HOT c_SDLWindow* findWindow(uint32_t windowID) const noexcept;
+public:
+	c_EventDispatcher(const c_EventDispatcher&) = delete;
+	c_EventDispatcher& operator=(const c_EventDispatcher&) = delete;
+	
+	//! Gets the dispatcher, which is created on first use.
+	static c_EventDispatcher& get();
+	
+	//! Called by c_SDLWindow itself on creation and destruction.
+	void addWindow(c_SDLWindow* window);
+	void removeWindow(c_SDLWindow* window);
+	//! Gets the number of windows known to the dispatcher.
+	const size_t getWindowCount() const noexcept;
+	
+	//! Hooks a function for events which belong to no window (e.g. SDL_QUIT, device and clipboard events).
+	//! The hookable functions are expected to process a vector of SDL_Event objects.
+	uint16_t addGlobalHook(const c_Hookable_Func& function);
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addGlobalHook(F handler) { return this->addGlobalHook(c_TypedHook<SDL_Event>::makeHookable(handler)); }
+	
+	//! Pumps and drains SDL's queue, routing each event to its window and running every window's hooks.
+	//! Returns a view of all the events, which stays valid until the next dispatch().
+	LIBANOP_FUNC_HOT c_SDLEventView dispatch();
+};
+
 //! Wrapper for any general SDL window. Implements basic window controls, surface control, and basic event access.
 //! Also provides simple functions for window control (i.e. force focus, minimize, maximize, or title updates)
 class c_SDLWindow {
+	friend class c_EventDispatcher;
+	
 	bool m_open = 0, m_hidden = 0;
+	uint32_t m_windowID = 0;
 	
 	SDL_Window* mp_window;
 	
@@ -76,12 +398,82 @@ class c_SDLWindow {
 	
 	SDL_Surface* mp_baseSurf;
 	
-	SDL_Event m_windowEvents;
+	// Buffers for each poll's events, reused by every poll so that once they have grown, polling allocates nothing.
+	std::vector<SDL_Event> m_polledAll, m_polledKeys, m_polledMouseBtn, m_polledMouseMove, m_polledMouseScrl, m_coalescedMouseMove;
+	
+	// Input recording (see startInputRecording).
+	std::ofstream m_recordFile;
+	std::vector<uint8_t> m_recordBuffer;
+	uint64_t m_recordStart = 0;
+	bool m_recording = 0;
+	
+	// Event waiting (see waitEvents).
+	uint16_t m_waitFrameMillis = 16;
+	uint32_t m_waitIdleMillis = 500;
+	uint64_t m_waitDeadline = 0;
+	c_SDLWaitStats m_waitStats;
+	c_LatencyHistogram m_waitEventLatency, m_waitOversleep;
+	
+	c_Function_Hook m_hookKeyboard, m_hookMouseBtn, m_hookMouseMove, m_hookMouseScrl, m_hookMouseMoveRaw;
+	bool m_coalesceMotion = 0;
+	uint64_t m_lastHookNanos = 0;
+	std::unique_ptr<c_InputTracer> mp_tracer; // Only while input tracing is on.
+	
+	// Partial presents (see setDirtyTracking).
+	Graphics::c_DirtyRegion m_dirty;
+	bool m_dirtyTracking = 0;
+	float m_dirtyFullCoverage = 0.5f;
+	c_SDLPresentStats m_presentStats;
 	
-	c_Function_Hook m_hookKeyboard, m_hookMouseBtn, m_hookMouseMove, m_hookMouseScrl;
+	std::unique_ptr<c_RenderThread> mp_render; // Since the first startRenderThread.
+	
+	// Render scaling (see setRenderScale). The backbuffer is empty while drawing goes straight to the surface.
+	float m_renderScale = 1;
+	Graphics::e_Scale_Filter m_scaleFilter = Graphics::SCALE_BILINEAR;
+	std::vector<uint32_t> m_backbuffer;
+	Graphics::c_PixelView m_backView;
+	
+	//! Runs a drawing function on the render target: the backbuffer, or else the surface (locking it if SDL needs that),
+	//! marking 'area' dirty. The backbuffer is scaled over the whole surface when presented, so marks nothing.
+	template <typename FuncT>
+	void drawTo(const SDL_Rect& area, FuncT draw) {
+		assert_safety( this->m_open );
+		if (!this->m_backbuffer.empty()) {
+			draw(this->m_backView);
+			return;
+		}
+		const bool Lock = SDL_MUSTLOCK(this->mp_baseSurf);
+		if (Lock) assert_libsdl( SDL_LockSurface(this->mp_baseSurf) == 0 );
+		draw(Graphics::c_PixelView::of(this->mp_baseSurf));
+		if (Lock) SDL_UnlockSurface(this->mp_baseSurf);
+		this->m_dirty.add(area);
+	}
+	
+	// Keyboard snapshots: held keys this poll and last poll, and which keys went down or up in between.
+	c_KeySet m_keysNow, m_keysBefore, m_keysPressed, m_keysReleased;
+	c_SDLEventRouter m_routeKeyboard{ROUTE_KEYBOARD}, m_routeMouseBtn{ROUTE_MOUSE_BUTTON},
+		m_routeMouseMove{ROUTE_MOUSE_MOTION}, m_routeMouseScrl{ROUTE_MOUSE_SCROLL};
 	
 	//! Updates surface, then frees surface and closes window. Does not deinitialize the pointers.
 	void cleanup();
+	//! Clears the poll buffers and takes the keyboard snapshot. SDL must have been pumped already.
+	void beginPoll();
+	//! Handles a polled event if it concerns the window itself, and sorts it into its input buffer if it has one.
+	void handleEvent(SDL_Event& event);
+	//! Adds an event routed here by c_EventDispatcher to this poll, and handles it.
+	void acceptEvent(const SDL_Event& event);
+	//! Records the poll if asked to, and runs the hooks.
+	void endPoll();
+	//! Sizes the backbuffer (and the render thread's buffers) to the surface times the render scale.
+	void fitBackbuffer();
+	//! Copies or scales a frame over the whole surface.
+	void showFrame(const Graphics::c_PixelView& frame);
+	//! Pushes the surface to the screen, all of it or just what is dirty; the second half of refreshWindowSurface.
+	void pushSurface();
+	//! Runs the input hooks on the sorted buffers, along with anything deferred to them.
+	void dispatchHooks();
+	//! Appends the events of the last poll to the input recording.
+	void recordPoll();
 public:
 	//! Initializes and opens the window with an undefined or centered position.
 	c_SDLWindow(uint16_t width, uint16_t height, std::string title, bool centerOnOpen, e_SDLWindow_Type openType = TYPE_GENERIC,
@@ -96,7 +488,44 @@ public:
 	//! Query if the window is even open/valid.
 	const bool isOpen() const noexcept;
 	//! Deques as many events as possible and handles them if they're window related or if they're related to input hooks.
+	//! Same as pollEvents(), but returns a copy of the events.
 	std::vector<SDL_Event> fullEventPoll();
+	//! Pumps SDL once, then drains its whole queue in blocks with SDL_PeepEvents into buffers the window keeps, and
+	//! handles the events as fullEventPoll does. Returns a view of the polled events instead of a new vector.
+	//! Only for single-window programs; otherwise use c_EventDispatcher::get().dispatch().
+	LIBANOP_FUNC_HOT c_SDLEventView pollEvents();
+	//! Polls like pollEvents, but first sleeps in SDL_WaitEventTimeout instead of spinning. While the window is active,
+	//! it waits for the next event or until the next frame is due, whichever comes first, so input is still picked up
+	//! as soon as it arrives. While hidden, minimized or unfocused, it blocks until an event or the idle timeout.
+	c_SDLEventView waitEvents();
+	//! Sets the frame period waitEvents keeps to while active, and how long it may block while idle.
+	void setWaitTiming(uint16_t frameMillis, uint32_t idleMillis);
+	//! Gets how long the hooks took to run in the last poll, in nanoseconds (part of the time the poll took).
+	uint64_t getLastHookNanos() const noexcept { return m_lastHookNanos; }
+	//! Gets what waitEvents has done since the window opened or resetWaitStats.
+	c_SDLWaitStats getWaitStats() const;
+	void resetWaitStats();
+	//! Turns input latency tracing on or off. While on, every keyboard and mouse event is followed from SDL's queue,
+	//! through the window's hooks, to the next present, and the times go into histograms by category. Turning it off
+	//! drops the collected times.
+	void setInputTracing(bool enabled);
+	bool getInputTracing() const noexcept;
+	//! Gets the traced latency of a category of input events, in nanoseconds.
+	c_SDLInputLatency getInputLatency(e_SDLTrace_Category category) const;
+	//! Clears the traced latencies, keeping tracing on.
+	void resetInputLatency();
+	//! Logs the traced latencies of every category which has seen events.
+	LIBANOP_FUNC_COLD void logInputLatencyReport() const;
+	//! Tells the tracer a frame has been shown. refreshWindowSurface and c_FrameScheduler do this themselves; programs
+	//! which present some other way (e.g. SDL_GL_SwapWindow) call it just after.
+	void markPresented();
+	//! Starts appending every polled event, with the time of its poll, to a compact binary file which c_InputReplay can
+	//! play back. Each poll costs one buffered write of about 32 bytes per event.
+	void startInputRecording(const std::string& path);
+	//! Stops recording and closes the file.
+	void stopInputRecording();
+	//! Gets whether input is being recorded.
+	const bool isRecordingInput() const noexcept;
 	/*
 	Scancode List:
 	
@@ -219,7 +648,17 @@ public:
 	//! Gets the most recent key presses from the last event poll.
 	LIBANOP_FUNC_HOT std::vector<SDL_Scancode> getLastKeys();
 	//! Tests if a given key is pressed in last poll.
-	LIBANOP_FUNC_HOT bool keyPressed(SDL_Scancode what);
+	LIBANOP_FUNC_HOT bool keyPressed(SDL_Scancode what) const noexcept { return m_keysNow.test(what); }
+	//! Tests if a given key went down between the previous poll and the last one.
+	LIBANOP_FUNC_HOT bool keyJustPressed(SDL_Scancode what) const noexcept { return m_keysPressed.test(what); }
+	//! Tests if a given key came up between the previous poll and the last one.
+	LIBANOP_FUNC_HOT bool keyJustReleased(SDL_Scancode what) const noexcept { return m_keysReleased.test(what); }
+	//! Gets the keys held as of the last poll.
+	const c_KeySet& getKeysHeld() const noexcept { return m_keysNow; }
+	//! Gets the keys which went down between the previous poll and the last one.
+	const c_KeySet& getKeysPressed() const noexcept { return m_keysPressed; }
+	//! Gets the keys which came up between the previous poll and the last one.
+	const c_KeySet& getKeysReleased() const noexcept { return m_keysReleased; }
 	//! Hooks a function for its Keyboard Event hook.
 	//! The hookable functions are expected to process a vector of SDL_Event objects (union member SDL_KeyboardEvent).
 	uint16_t addHook_KeyboardEvent(const c_Hookable_Func& function);
@@ -232,6 +671,50 @@ public:
 	//! Hooks a function for its Mouse Scroll Event hook.
 	//! The hookable functions are expected to process a vector of SDL_Event objects (union member SDL_MouseScrollEvent).
 	uint16_t addHook_MouseScrollEvent(const c_Hookable_Func& function);
+	//! Hooks a function which always gets every mouse motion event, even while motion coalescing is on.
+	//! The hookable functions are expected to process a vector of SDL_Event objects (union member SDL_MouseMotionEvent).
+	uint16_t addHook_MouseMotionRawEvent(const c_Hookable_Func& function);
+	
+	//! Turns mouse motion coalescing on or off (the default). While on, each run of motion events from the same mouse
+	//! reaches the motion hooks as one event, with the summed 'xrel'/'yrel', the final position and the buttons held at
+	//! any point. Functions hooked with addHook_MouseMotionRawEvent still see every event.
+	void setMouseMotionCoalescing(bool coalesce) noexcept;
+	//! Gets whether mouse motion coalescing is on.
+	const bool getMouseMotionCoalescing() const noexcept;
+	
+	// Filtered versions of the above: the function only gets the events matching 'filter' (see c_SDLEventFilter), and is
+	// not even called in polls without any. These return the number of filtered functions on the same hook.
+	uint16_t addHook_KeyboardEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter);
+	uint16_t addHook_MouseButtonEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter);
+	uint16_t addHook_MouseMotionEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter);
+	uint16_t addHook_MouseScrollEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter);
+	
+	// Typed versions of the above: 'handler' is any callable taking (const SDL_Event* Events, size_t Count) and returning
+	// c_HookReturn or nothing, with up to c_HookCallable::Capacity bytes of captured state. See c_TypedHook.
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_KeyboardEvent(F handler) { return this->addHook_KeyboardEvent(c_TypedHook<SDL_Event>::makeHookable(handler)); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseButtonEvent(F handler) { return this->addHook_MouseButtonEvent(c_TypedHook<SDL_Event>::makeHookable(handler)); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseMotionEvent(F handler) { return this->addHook_MouseMotionEvent(c_TypedHook<SDL_Event>::makeHookable(handler)); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseScrollEvent(F handler) { return this->addHook_MouseScrollEvent(c_TypedHook<SDL_Event>::makeHookable(handler)); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseMotionRawEvent(F handler) { return this->addHook_MouseMotionRawEvent(c_TypedHook<SDL_Event>::makeHookable(handler)); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_KeyboardEvent(F handler, const c_SDLEventFilter& filter) { return this->addHook_KeyboardEvent(c_TypedHook<SDL_Event>::makeHookable(handler), filter); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseButtonEvent(F handler, const c_SDLEventFilter& filter) { return this->addHook_MouseButtonEvent(c_TypedHook<SDL_Event>::makeHookable(handler), filter); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseMotionEvent(F handler, const c_SDLEventFilter& filter) { return this->addHook_MouseMotionEvent(c_TypedHook<SDL_Event>::makeHookable(handler), filter); }
+	template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, c_Hookable_Func>::value>::type>
+	uint16_t addHook_MouseScrollEvent(F handler, const c_SDLEventFilter& filter) { return this->addHook_MouseScrollEvent(c_TypedHook<SDL_Event>::makeHookable(handler), filter); }
+	// Raise an event into the matching hook from any thread. It is queued, and handed to the hooked functions by the
+	// next poll, in the same batch as the events SDL delivered.
+	void deferKeyboardEvent(const SDL_Event& event);
+	void deferMouseButtonEvent(const SDL_Event& event);
+	void deferMouseMotionEvent(const SDL_Event& event);
+	void deferMouseScrollEvent(const SDL_Event& event);
 	//! Gets the current height.
 	const uint16_t getWindowHeight() const noexcept;
 	//! Gets the current width.
@@ -270,14 +753,73 @@ public:
 	void focusWindow();
 	//! Restores window from maximizing/minimizing
 	void restoreFromMinMax();
-	//! Refresh the draw surface
+	//! Refresh the draw surface. With dirty tracking on, only what has been marked dirty since the last refresh is pushed.
+	//! With a render scale below 1, the backbuffer is scaled over the surface first.
 	void refreshWindowSurface();
+	//! Turns dirty tracking on or off. While on, refreshWindowSurface pushes only the dirty rectangles (through
+	//! SDL_UpdateWindowSurfaceRects), the whole surface once they cover enough of it, and nothing if nothing is dirty.
+	//! The draw* calls mark what they draw; anything drawn to getRawSDLSurface directly must be marked with markDirty.
+	void setDirtyTracking(bool enabled);
+	bool getDirtyTracking() const noexcept;
+	//! Sets how many wasted pixels merging two dirty rectangles may cost, and the fraction of the surface past which a
+	//! present pushes all of it.
+	void setDirtyThresholds(uint32_t mergeCost, float fullCoverage);
+	//! Marks part of the surface as changed.
+	void markDirty(const SDL_Rect& rect);
+	//! Marks the whole surface as changed.
+	void markAllDirty();
+	//! Gets what has changed since the last refresh.
+	const Graphics::c_DirtyRegion& getDirtyRegion() const noexcept;
+	//! Gets what refreshWindowSurface has pushed since the window opened or resetPresentStats.
+	c_SDLPresentStats getPresentStats() const noexcept;
+	void resetPresentStats() noexcept;
+	//! Fills a rectangle of the surface (or all of it, if NULL). See Graphics::fillRect.
+	void drawRect(const SDL_Rect* rect, uint32_t color);
+	//! Fills the whole surface.
+	void drawClear(uint32_t color);
+	//! Copies pixels onto the surface at x, y. See Graphics::blit and its variants.
+	void drawBlit(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y);
+	void drawBlitKeyed(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y, uint32_t key);
+	void drawBlitBlended(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y);
+	//! Draws everything recorded in 'renderer' onto the surface in parallel, and marks what it drew.
+	void drawTiled(Graphics::c_TiledRenderer& renderer);
+	//! Sets the resolution frames are drawn at, as a fraction (above 0, up to 1) of the surface's width and height. Below
+	//! 1, the draw* calls and the render thread draw into a backbuffer that size, with coordinates in its pixels, and each
+	//! present scales it over the whole surface with 'filter'. At 1, they draw straight to the surface, as before.
+	//! c_FrameScheduler::setDynamicResolution adjusts this from frame times.
+	void setRenderScale(float scale, Graphics::e_Scale_Filter filter = Graphics::SCALE_BILINEAR);
+	float getRenderScale() const noexcept;
+	Graphics::e_Scale_Filter getScaleFilter() const noexcept;
+	//! Gets the size of the render target: the backbuffer, or else the surface.
+	int32_t getRenderWidth() const noexcept;
+	int32_t getRenderHeight() const noexcept;
+	//! Gets the render target, to draw to with the Graphics functions directly; see setRenderScale. When that is the
+	//! surface, it must be locked first if SDL_MUSTLOCK says so, and what is drawn marked with markDirty.
+	Graphics::c_PixelView getRenderTarget();
+	//! Starts drawing frames on a thread of their own with 'render', into 'buffers' (2 or 3) back buffers, so a slow
+	//! frame no longer holds up polling and the hooks; the main thread keeps polling and calls presentRendered once a
+	//! frame. Finished buffers are handed over with a single atomic exchange, never a lock. Double buffering has the
+	//! thread wait until its last frame has been shown before handing over the next one, so it draws no more frames
+	//! than are shown; triple buffering never waits, and shows the newest frame, dropping any it replaced.
+	void startRenderThread(t_RenderThreadFunc render, uint8_t buffers = 2);
+	//! Stops the render thread, after the frame it is drawing. Closing the window does this too.
+	void stopRenderThread();
+	//! Gets whether the render thread is running.
+	bool isRenderThreadRunning() const noexcept;
+	//! Copies (or scales, per setRenderScale) the newest frame the render thread finished onto the surface and refreshes it. Returns false, showing
+	//! nothing, if no frame has been finished since the last call. c_FrameScheduler calls this instead of
+	//! refreshWindowSurface while the render thread runs.
+	bool presentRendered();
+	//! Gets what the render thread has done since it was started.
+	c_SDLRenderStats getRenderStats() const;
 	//! Grab the mouse
 	void grabMouseFocus();
 	//! Grab the keyboard
 	void grabKeyboardFocus();
 	//! Release input grab
 	void releaseInputFocus();
+	//! Gets the SDL window ID, which events name their window by.
+	const uint32_t getWindowID() const noexcept;
 	//! Returns the SDL_Window* for other actions is necessary
 	SDL_Window* getRawSDLWindow();
 	//! Returns the surface for drawing
@@ -29,9 +29,40 @@
 
 #include "../include/base.hpp"
 
+#if LIBANOP_CLOCK_TSC
+	#include <cpuid.h>
+#endif
+
 namespace Anoptamin {
 	
 	namespace Base {
+		LIBANOP_FUNC_EXPORT bool anoptamin_clocktsc = 0;
+		LIBANOP_FUNC_EXPORT uint64_t anoptamin_clockmult = uint64_t(1) << 32;
+		
+		void LIBANOP_FUNC_COLD LIBANOP_FUNC_CODEPT clockCalibrate() {
+			anoptamin_clocktsc = 0;
+			anoptamin_clockmult = uint64_t(1) << 32;
+		#if LIBANOP_CLOCK_TSC
+			// CPUID 0x80000007, EDX bit 8: the TSC runs at a constant rate in every power state.
+			unsigned int EAX, EBX, ECX, EDX;
+			if (!__get_cpuid(0x80000007, &EAX, &EBX, &ECX, &EDX) || !(EDX & (1u << 8))) return;
+			
+			const uint64_t StartNs = clockMonotonicNanos(), StartTsc = __rdtsc();
+			uint64_t EndNs, EndTsc;
+			do {
+				EndNs = clockMonotonicNanos();
+				EndTsc = __rdtsc();
+			} while (EndNs - StartNs < 5000000);
+			if (EndTsc <= StartTsc) return;
+			
+			anoptamin_clockmult = ((EndNs - StartNs) << 32) / (EndTsc - StartTsc);
+			anoptamin_clocktsc = (anoptamin_clockmult != 0);
+			if (!anoptamin_clocktsc) anoptamin_clockmult = uint64_t(1) << 32;
+		#endif
+		}
+		// Calibrate when the library is loaded, so the clock is usable before SetupFiles().
+		static const bool anoptamin_clockready = (clockCalibrate(), true);
+		
 		void LIBANOP_FUNC_COLD LIBANOP_FUNC_CODEPT dbg_stacktrace() {
 			uint64_t* pointers[64];
 			
@@ -78,6 +109,8 @@ namespace Anoptamin {
 				Log::Log(Log::LOG_TRACE, "System Errno: " + std::to_string(errno));
 				Log::Log(Log::LOG_TRACE, "SDL2 Error State: " + newerr );
 				Log::Log(Log::LOG_COMMON, "Aborting Program!");
+				Log::DisableAsyncLogging();
+				Log::FlushLogs();
 				anoptamin_logf.close();
 			} else {
 				std::cerr << "Logging Facility Not Open!\n";
@@ -140,36 +173,702 @@ namespace Anoptamin {
 			};
 		}}
 		*/
+		c_LatencyHistogram::c_LatencyHistogram() {
+			this->reset();
+		}
+		uint64_t LIBANOP_FUNC_CODEPT c_LatencyHistogram::bucketHighest(uint16_t bucket) {
+			if (bucket < SubBuckets) return bucket;
+			const uint32_t Msb = bucket / SubBuckets + 3, Sub = bucket % SubBuckets;
+			return ((uint64_t(SubBuckets + Sub) + 1) << (Msb - 4)) - 1;
+		}
+		uint64_t LIBANOP_FUNC_CODEPT c_LatencyHistogram::getPercentile(double percent) const {
+			const uint64_t Total = m_total.load(std::memory_order_relaxed);
+			if (Total == 0) return 0;
+			uint64_t Wanted = uint64_t(std::ceil(double(Total) * percent / 100.0));
+			if (Wanted == 0) Wanted = 1;
+			uint64_t Seen = 0;
+			for (uint16_t i = 0; i < Buckets; i++) {
+				Seen += m_counts[i].load(std::memory_order_relaxed);
+				if (Seen >= Wanted) return std::min(bucketHighest(i), m_max.load(std::memory_order_relaxed));
+			}
+			return m_max.load(std::memory_order_relaxed);
+		}
+		c_LatencySummary LIBANOP_FUNC_CODEPT c_LatencyHistogram::getSummary() const {
+			c_LatencySummary Out;
+			Out.Count = m_total.load(std::memory_order_relaxed);
+			Out.P50 = this->getPercentile(50.0);
+			Out.P99 = this->getPercentile(99.0);
+			Out.Max = m_max.load(std::memory_order_relaxed);
+			return Out;
+		}
+		void LIBANOP_FUNC_CODEPT c_LatencyHistogram::reset() {
+			for (uint16_t i = 0; i < Buckets; i++) m_counts[i].store(0, std::memory_order_relaxed);
+			m_total.store(0, std::memory_order_relaxed);
+			m_max.store(0, std::memory_order_relaxed);
+		}
+		
+		// Every live hook, for the latency report. Hooks add themselves on construction and leave on destruction.
+		static std::mutex anoptamin_hookregistrylock;
+		static std::vector<c_Function_Hook*> anoptamin_hookregistry;
+		static std::atomic<uint64_t> anoptamin_hookreportevery(0), anoptamin_hookreportnext(0);
+		static std::atomic<c_HookHandle> anoptamin_hookhandles(1); // Next handle HookFunction hands out.
+		
+		static void RegisterHook(c_Function_Hook* hook) {
+			std::lock_guard<std::mutex> Guard(anoptamin_hookregistrylock);
+			anoptamin_hookregistry.push_back(hook);
+		}
+		
+		bool LIBANOP_FUNC_CODEPT getHookLatency(const std::string& hookName, uint16_t index, c_LatencySummary& out) {
+			std::lock_guard<std::mutex> Guard(anoptamin_hookregistrylock);
+			for (c_Function_Hook* H : anoptamin_hookregistry) {
+				if (H->Name != hookName) continue;
+				const c_HookSnapshot List = H->getHookedFuncs();
+				if (index >= List->Funcs.size()) continue;
+				out = List->Funcs[index].Func_Latency->getSummary();
+				return true;
+			}
+			return false;
+		}
+		
+		void LIBANOP_FUNC_COLD LIBANOP_FUNC_CODEPT logHookLatencyReport(uint16_t topCount) {
+			struct c_Entry {
+				std::string Name;
+				uint16_t Index;
+				c_LatencySummary Latency;
+			};
+			std::vector<c_Entry> Entries;
+			{
+				std::lock_guard<std::mutex> Guard(anoptamin_hookregistrylock);
+				for (c_Function_Hook* H : anoptamin_hookregistry) {
+					const c_HookSnapshot List = H->getHookedFuncs();
+					for (size_t i = 0; i < List->Funcs.size(); i++) {
+						c_LatencySummary L = List->Funcs[i].Func_Latency->getSummary();
+						if (L.Count != 0) Entries.push_back({H->Name, uint16_t(i), L});
+					}
+				}
+			}
+			std::sort(Entries.begin(), Entries.end(), [](const c_Entry& a, const c_Entry& b) { return a.Latency.P99 > b.Latency.P99; });
+			if (Entries.size() > topCount) Entries.resize(topCount);
+			
+			Anoptamin_LogInfo("Hook latency report, " + std::to_string(Entries.size()) + " slowest hooked functions by p99 (ns):");
+			for (const c_Entry& E : Entries) {
+				Anoptamin_LogInfoF("  '{}' Function #{}: {} calls, p50 {}, p99 {}, max {}",
+					E.Name, E.Index, E.Latency.Count, E.Latency.P50, E.Latency.P99, E.Latency.Max);
+			}
+		}
+		
+		void LIBANOP_FUNC_CODEPT setHookReportInterval(uint32_t seconds) {
+		#if LIBANOP_GNU && defined(__SIZEOF_INT128__)
+			const uint64_t Every = (seconds == 0) ? 0 : uint64_t((static_cast<unsigned __int128>(seconds) * 1000000000ull << 32) / anoptamin_clockmult);
+		#else
+			const uint64_t Every = (seconds == 0) ? 0 : uint64_t(double(seconds) * 1e9 * (4294967296.0 / double(anoptamin_clockmult)));
+		#endif
+			anoptamin_hookreportnext.store(clockTicks() + Every, std::memory_order_relaxed);
+			anoptamin_hookreportevery.store(Every, std::memory_order_relaxed);
+		}
+		
+		//! Fills in the run order and dependency graph of a hook list. Returns false if the ordering edges form a cycle.
+		static bool BuildHookSchedule(c_HookList& L) {
+			const size_t N = L.Funcs.size();
+			L.Order.clear();
+			L.DepCount.assign(N, 0);
+			L.Dependents.assign(N, {});
+			L.HasParallelism = 0;
+			
+			std::vector<bool> IsDep(N);
+			long LastSerial = -1;
+			for (size_t j = 0; j < N; j++) {
+				const c_Hookable_Func& F = L.Funcs[j];
+				std::fill(IsDep.begin(), IsDep.end(), false);
+				for (c_HookFuncPtr After : F.Func_RunsAfter) {
+					for (size_t i = 0; i < N; i++) if (i != j && After != NULL && L.Funcs[i].Function == After) IsDep[i] = true;
+				}
+				for (c_HookHandle After : F.Func_RunsAfterHandles) {
+					for (size_t i = 0; i < N; i++) if (i != j && After != 0 && L.Funcs[i].Func_Handle == After) IsDep[i] = true;
+				}
+				if (!F.Func_Independent) {
+					if (LastSerial >= 0) IsDep[LastSerial] = true;
+					LastSerial = long(j);
+				} else {
+					L.HasParallelism = (N > 1);
+				}
+				for (size_t i = 0; i < N; i++) {
+					if (!IsDep[i]) continue;
+					L.Dependents[i].push_back(uint16_t(j));
+					L.DepCount[j]++;
+				}
+			}
+			
+			// Kahn's algorithm, always taking the earliest registered function that is ready.
+			std::vector<uint16_t> Pending = L.DepCount;
+			std::vector<bool> Done(N);
+			for (size_t step = 0; step < N; step++) {
+				size_t k = 0;
+				while (k < N && (Done[k] || Pending[k] != 0)) k++;
+				if (k == N) return false;
+				Done[k] = true;
+				L.Order.push_back(uint16_t(k));
+				for (uint16_t d : L.Dependents[k]) Pending[d]--;
+			}
+			return true;
+		}
+		
 		c_Function_Hook::c_Function_Hook(const char* title, bool catchErrs) {
 			Name = title;
 			CatchHookedErrors = catchErrs;
+			HookEpoch.store(0); HookReaders[0].store(0); HookReaders[1].store(0);
+			{
+				std::lock_guard<std::mutex> Guard(this->HookLock);
+				this->PublishList(std::make_shared<c_HookList>());
+			}
+			RegisterHook(this);
 		}
 		c_Function_Hook::c_Function_Hook() {
 			Name = "Undefined";
 			CatchHookedErrors = 0;
+			HookEpoch.store(0); HookReaders[0].store(0); HookReaders[1].store(0);
+			{
+				std::lock_guard<std::mutex> Guard(this->HookLock);
+				this->PublishList(std::make_shared<c_HookList>());
+			}
+			RegisterHook(this);
 		}
 		//! Copies over the name and hook config, but none of the hooked functions.
 		c_Function_Hook::c_Function_Hook(const c_Function_Hook& b) {
 			Name = b.Name;
 			CatchHookedErrors = b.CatchHookedErrors;
+			ParallelInvoke = b.ParallelInvoke;
+			HookEpoch.store(0); HookReaders[0].store(0); HookReaders[1].store(0);
+			{
+				std::lock_guard<std::mutex> Guard(this->HookLock);
+				this->PublishList(std::make_shared<c_HookList>());
+			}
+			RegisterHook(this);
+		}
+		c_Function_Hook::~c_Function_Hook() {
+			std::lock_guard<std::mutex> Guard(anoptamin_hookregistrylock);
+			for (size_t i = 0; i < anoptamin_hookregistry.size(); i++) {
+				if (anoptamin_hookregistry[i] != this) continue;
+				anoptamin_hookregistry.erase(anoptamin_hookregistry.begin() + i);
+				break;
+			}
+		}
+		c_LatencySummary LIBANOP_FUNC_CODEPT c_Function_Hook::getLatency(uint16_t index) const {
+			const c_HookSnapshot List = this->getHookedFuncs();
+			check_bounds( index < List->Funcs.size() );
+			return List->Funcs[index].Func_Latency->getSummary();
+		}
+		uint16_t LIBANOP_FUNC_CODEPT c_Function_Hook::HookFunction(const c_Hookable_Func& function, c_HookHandle* Handle) {
+			check_ptr( function.Function != NULL || bool(function.Func_Callable) );
+			std::lock_guard<std::mutex> Guard(this->HookLock);
+			
+			const c_HookSnapshot& Old = this->HookedOwner;
+			check_codelogic( Old->Funcs.size() < 600 ); // We're gonna avoid having more than 600 functions called on a hook...
+			std::shared_ptr<c_HookList> New = std::make_shared<c_HookList>();
+			New->Funcs = Old->Funcs;
+			New->Funcs.push_back(function);
+			if (!New->Funcs.back().Func_Latency) New->Funcs.back().Func_Latency = std::make_shared<c_LatencyHistogram>();
+			const c_HookHandle NewHandle = anoptamin_hookhandles.fetch_add(1, std::memory_order_relaxed);
+			New->Funcs.back().Func_Handle = NewHandle;
+			check_hooked( BuildHookSchedule(*New) ); // Func_RunsAfter edges can't be circular
+			const uint16_t NewSize = uint16_t(New->Funcs.size());
+			this->PublishList(std::move(New));
+			if (Handle != NULL) *Handle = NewHandle;
+			return NewSize;
+		}
+		bool LIBANOP_FUNC_CODEPT c_Function_Hook::UnhookFunction(c_HookFuncPtr function) {
+			std::lock_guard<std::mutex> Guard(this->HookLock);
+			
+			const c_HookSnapshot Old = this->HookedOwner;
+			for (size_t i = 0; i < Old->Funcs.size(); i++) {
+				if (function == NULL || Old->Funcs[i].Function != function) continue;
+				std::shared_ptr<c_HookList> New = std::make_shared<c_HookList>();
+				New->Funcs = Old->Funcs;
+				New->Funcs.erase(New->Funcs.begin() + i);
+				check_hooked( BuildHookSchedule(*New) );
+				this->PublishList(std::move(New));
+				return true;
+			}
+			return false;
+		}
+		bool LIBANOP_FUNC_CODEPT c_Function_Hook::UnhookHandle(c_HookHandle handle) {
+			std::lock_guard<std::mutex> Guard(this->HookLock);
+			
+			const c_HookSnapshot Old = this->HookedOwner;
+			for (size_t i = 0; i < Old->Funcs.size(); i++) {
+				if (handle == 0 || Old->Funcs[i].Func_Handle != handle) continue;
+				std::shared_ptr<c_HookList> New = std::make_shared<c_HookList>();
+				New->Funcs = Old->Funcs;
+				New->Funcs.erase(New->Funcs.begin() + i);
+				check_hooked( BuildHookSchedule(*New) );
+				this->PublishList(std::move(New));
+				return true;
+			}
+			return false;
+		}
+		c_HookSnapshot LIBANOP_FUNC_CODEPT c_Function_Hook::getHookedFuncs() const {
+			std::lock_guard<std::mutex> Guard(this->HookLock);
+			return this->HookedOwner;
+		}
+		void LIBANOP_FUNC_CODEPT c_Function_Hook::PublishList(std::shared_ptr<c_HookList> New) {
+			if (this->HookedOwner) this->HookedRetired[0].push_back(std::move(this->HookedOwner));
+			this->HookedOwner = std::move(New);
+			this->HookedFuncs.store(this->HookedOwner.get());
+			
+			// Invokes counted under the last epoch may hold anything retired back then. Invokes counted under this one
+			// started after the last epoch's retirements were replaced, so once the last epoch's count is zero those
+			// lists are unused, and its slot is free for the next epoch.
+			const uint32_t Epoch = this->HookEpoch.load();
+			if (this->HookReaders[(Epoch + 1) & 1].load() != 0) return;
+			this->HookedRetired[1].clear();
+			this->HookedRetired[1].swap(this->HookedRetired[0]);
+			this->HookEpoch.store(Epoch + 1);
+		}
+		void LIBANOP_FUNC_CODEPT c_Function_Hook::CallHooked(const c_Hookable_Func& X, size_t index, const void* Data, size_t Count, uint16_t SizeData, c_HookReturn& N) {
+			const uint64_t Start = clockTicks();
+			try {
+				if (X.Func_Callable) {
+					if (X.Func_NoInputs) N = X.Func_Callable(NULL, 0, 0); else N = X.Func_Callable(Data, Count, SizeData);
+				} else {
+					if (X.Func_NoInputs) N = X.Function(0, 0, NULL); else N = X.Function(Count, SizeData, Data);
+				}
+			} catch (std::exception* E) {
+				if (this->CatchHookedErrors) {
+					std::string X = E->what();
+					Anoptamin_LogWarn("Caught exception in Hook '" + this->Name + "', Function #" + std::to_string(index));
+					Anoptamin_LogTrace("Error Info: " + X);
+					N.MainData.clear();
+					N.Valid = 0;
+				} else {
+					X.Func_Latency->record(clockTicksToNanos(clockTicks() - Start));
+					throw *E;
+				}
+			}
+			const uint64_t Elapsed = clockTicksToNanos(clockTicks() - Start);
+			X.Func_Latency->record(Elapsed);
+			N.ElapsedTicks = uint32_t(Elapsed < UINT32_MAX ? Elapsed : UINT32_MAX);
+		}
+		
+		//! State of one parallel invoke. Lives on the invoking thread's stack until every task has finished.
+		struct c_ParallelInvoke;
+		struct c_ParallelTask {
+			c_ParallelInvoke* Invoke;
+			uint16_t Index;
+		};
+		struct c_ParallelInvoke {
+			c_Function_Hook* Hook;
+			const c_HookList* List;
+			const void* Data;
+			size_t Count;
+			uint16_t SizeData;
+			std::vector<c_HookReturn>* Results;
+			c_WorkerPool* Pool;
+			std::unique_ptr<std::atomic<uint16_t>[]> Pending;
+			std::vector<c_ParallelTask> Tasks;
+			std::atomic<size_t> Remaining;
+			std::mutex ErrorLock;
+			std::exception_ptr Error;
+		};
+		
+		static void RunParallelTask(void* context) {
+			c_ParallelTask* T = static_cast<c_ParallelTask*>(context);
+			c_ParallelInvoke* P = T->Invoke;
+			const uint16_t i = T->Index;
+			
+			c_HookReturn Discard;
+			c_HookReturn& N = (P->Results != NULL) ? (*P->Results)[i] : Discard;
+			try {
+				P->Hook->CallHooked(P->List->Funcs[i], i, P->Data, P->Count, P->SizeData, N);
+			} catch (...) {
+				std::lock_guard<std::mutex> Guard(P->ErrorLock);
+				if (!P->Error) P->Error = std::current_exception();
+			}
+			for (uint16_t d : P->List->Dependents[i]) {
+				if (P->Pending[d].fetch_sub(1, std::memory_order_acq_rel) == 1) P->Pool->submit(RunParallelTask, &P->Tasks[d]);
+			}
+			// Must be the last touch of 'P'; the invoking thread may return as soon as this hits zero.
+			P->Remaining.fetch_sub(1, std::memory_order_release);
+		}
+		
+		void LIBANOP_FUNC_CODEPT c_DeferredQueue::push(const void* Data, size_t Count, uint16_t SizeData) {
+			if (Count == 0) return;
+			std::lock_guard<std::mutex> Guard(m_lock);
+			if (m_pending.empty()) m_itemSize = SizeData;
+			check_param( SizeData == m_itemSize );
+			const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+			m_pending.insert(m_pending.end(), Bytes, Bytes + Count * SizeData);
+			m_count.fetch_add(Count, std::memory_order_relaxed);
+		}
+		LIBANOP_FUNC_CODEPT const std::vector<uint8_t>& c_DeferredQueue::take(uint16_t& SizeData, uint16_t Expected) {
+			m_taken.clear();
+			std::lock_guard<std::mutex> Guard(m_lock);
+			check_param( Expected == 0 || m_pending.empty() || m_itemSize == Expected );
+			m_pending.swap(m_taken);
+			SizeData = m_itemSize;
+			m_count.store(0, std::memory_order_relaxed);
+			return m_taken;
+		}
+		
+		size_t LIBANOP_FUNC_CODEPT c_Function_Hook::DrainDeferred(std::vector<c_HookReturn>* Results) {
+			if (this->Deferred.size() == 0) return 0;
+			uint16_t SizeData;
+			const std::vector<uint8_t>& Taken = this->Deferred.take(SizeData);
+			if (Taken.empty()) return 0;
+			const size_t Count = Taken.size() / SizeData;
+			this->InvokeRaw(Taken.data(), Count, SizeData, Results);
+			return Count;
+		}
+		
+		//! Writes the periodic latency report, if it is due and no other invoke beat us to it.
+		static inline void CheckHookReport() {
+			const uint64_t Every = anoptamin_hookreportevery.load(std::memory_order_relaxed);
+			if (Every == 0) return;
+			const uint64_t Now = clockTicks();
+			uint64_t Next = anoptamin_hookreportnext.load(std::memory_order_relaxed);
+			if (Now < Next) return;
+			if (anoptamin_hookreportnext.compare_exchange_strong(Next, Now + Every, std::memory_order_relaxed)) logHookLatencyReport();
+		}
+		
+		void LIBANOP_FUNC_CODEPT c_Function_Hook::InvokeRaw(const void* Data, size_t Count, uint16_t SizeData, std::vector<c_HookReturn>* Results) {
+			// Counted in for as long as we use the list, so a concurrent HookFunction can't free it out from under us.
+			// If the epoch moves on while we count ourselves in, we count in again under the new one.
+			struct c_ReadGuard {
+				std::atomic<uint32_t>* Readers;
+				c_ReadGuard(c_Function_Hook& hook) {
+					for (;;) {
+						const uint32_t Epoch = hook.HookEpoch.load();
+						Readers = &hook.HookReaders[Epoch & 1];
+						Readers->fetch_add(1);
+						if (hook.HookEpoch.load() == Epoch) break;
+						Readers->fetch_sub(1);
+					}
+				}
+				~c_ReadGuard() { Readers->fetch_sub(1); }
+			} Guard(*this);
+			const c_HookList* List = this->HookedFuncs.load();
+			const size_t NumFuncs = List->Funcs.size();
+			if (Results != NULL) Results->resize(NumFuncs);
+			
+			if (!this->ParallelInvoke || !List->HasParallelism) {
+				c_HookReturn Discard;
+				for (uint16_t i : List->Order) {
+					this->CallHooked(List->Funcs[i], i, Data, Count, SizeData, (Results != NULL) ? (*Results)[i] : Discard);
+				}
+				CheckHookReport();
+				return;
+			}
+			
+			c_ParallelInvoke P;
+			P.Hook = this; P.List = List;
+			P.Data = Data; P.Count = Count; P.SizeData = SizeData;
+			P.Results = Results;
+			P.Pool = &c_WorkerPool::getShared();
+			P.Pending.reset(new std::atomic<uint16_t>[NumFuncs]);
+			P.Tasks.resize(NumFuncs);
+			P.Remaining.store(NumFuncs, std::memory_order_relaxed);
+			for (size_t i = 0; i < NumFuncs; i++) {
+				P.Pending[i].store(List->DepCount[i], std::memory_order_relaxed);
+				P.Tasks[i] = {&P, uint16_t(i)};
+			}
+			for (size_t i = 0; i < NumFuncs; i++) {
+				if (List->DepCount[i] == 0) P.Pool->submit(RunParallelTask, &P.Tasks[i]);
+			}
+			while (P.Remaining.load(std::memory_order_acquire) != 0) {
+				if (!P.Pool->runOne()) std::this_thread::yield();
+			}
+			if (P.Error) std::rethrow_exception(P.Error);
+			CheckHookReport();
+		}
+		
+		LIBANOP_FUNC_CODEPT c_WorkerPool::c_WorkerPool(uint16_t threads) {
+			if (threads == 0) {
+				const unsigned int Hardware = std::thread::hardware_concurrency();
+				threads = (Hardware > 2) ? uint16_t(Hardware - 1) : 1;
+			}
+			for (uint16_t i = 0; i < threads; i++) m_threads.emplace_back(&c_WorkerPool::workerLoop, this);
+		}
+		LIBANOP_FUNC_CODEPT c_WorkerPool::~c_WorkerPool() {
+			{
+				std::lock_guard<std::mutex> Guard(m_lock);
+				m_stopping = 1;
+			}
+			m_wake.notify_all();
+			for (std::thread& T : m_threads) T.join();
+		}
+		LIBANOP_FUNC_CODEPT void c_WorkerPool::workerLoop() {
+			for (;;) {
+				std::unique_lock<std::mutex> L(m_lock);
+				m_wake.wait(L, [this]() { return m_stopping || !m_tasks.empty(); });
+				if (m_tasks.empty()) return;
+				c_Task T = m_tasks.front();
+				m_tasks.pop_front();
+				L.unlock();
+				T.Function(T.Context);
+			}
 		}
-		uint16_t LIBANOP_FUNC_CODEPT c_Function_Hook::HookFunction(const c_Hookable_Func& function) {
-			this->HookLock.lock();
-			check_ptr( function.Function != NULL );
-			check_codelogic( this->HookedFuncs.size() < 600 ); // We're gonna avoid having more than 600 functions called on a hook...
-			this->HookedFuncs.push_back(function);
-			this->HookLock.unlock();
-			return this->HookedFuncs.size();
+		LIBANOP_FUNC_CODEPT void c_WorkerPool::submit(void (*function)(void*), void* context) {
+			check_ptr( function != NULL );
+			{
+				std::lock_guard<std::mutex> Guard(m_lock);
+				m_tasks.push_back({function, context});
+			}
+			m_wake.notify_one();
+		}
+		LIBANOP_FUNC_CODEPT bool c_WorkerPool::runOne() {
+			std::unique_lock<std::mutex> L(m_lock);
+			if (m_tasks.empty()) return false;
+			c_Task T = m_tasks.front();
+			m_tasks.pop_front();
+			L.unlock();
+			T.Function(T.Context);
+			return true;
+		}
+		LIBANOP_FUNC_CODEPT const uint16_t c_WorkerPool::getThreadCount() const noexcept {
+			return uint16_t(m_threads.size());
+		}
+		LIBANOP_FUNC_CODEPT c_WorkerPool& c_WorkerPool::getShared() {
+			// Never destroyed, so hooks invoked during static destruction still have somewhere to run.
+			static c_WorkerPool* Shared = new c_WorkerPool();
+			return *Shared;
 		}
 		
 	} // End Base namespace
 	
 	namespace Log {
+		//! A single log record as it is handed to the writer thread.
+		struct c_LogRecord {
+			e_LogSeverity Severity;
+			uint64_t Timestamp;
+			std::string Message;
+		};
+		
+		//! One cell of the asynchronous ring. 'Sequence' follows the bounded MPMC queue scheme by D. Vyukov; producers
+		//! are allowed to dequeue too, which is how OVERFLOW_DROP_OLDEST makes room without the writer.
+		struct c_LogSlot {
+			std::atomic<size_t> Sequence;
+			c_LogRecord Record;
+		};
+		
+		static c_LogSlot* anoptamin_logring = NULL;
+		static size_t anoptamin_logmask = 0;
+		alignas(64) static std::atomic<size_t> anoptamin_loghead(0);
+		alignas(64) static std::atomic<size_t> anoptamin_logtail(0);
+		alignas(64) static std::atomic<bool> anoptamin_logasync(0);
+		static std::atomic<bool> anoptamin_logstop(0), anoptamin_logbusy(0), anoptamin_logsleeping(0);
+		static std::atomic<uint64_t> anoptamin_logdropped(0);
+		static std::atomic<uint32_t> anoptamin_loginflight(0); //!< Producers that may be touching the ring.
+		static e_LogOverflow anoptamin_logpolicy = OVERFLOW_BLOCK;
+		static std::thread* anoptamin_logwriter = NULL; // Only touched by Enable/DisableAsyncLogging.
+		static std::atomic<std::thread::id> anoptamin_logwriterid; // The writer's ID while it runs, for any thread to compare against.
+		static std::mutex anoptamin_logwakelock;
+		static std::condition_variable anoptamin_logwake;
+		
+		// Binary log layout (all integers little-endian, as written by the host):
+		//   Header:     "ANOPALOG", u16 version, u64 start time (us after the Unix epoch), u16 length + creation date text
+		//   Descriptor: u8 1, u32 ID, u8 severity, u8 argc, argc x u8 type code, u16 length + format text
+		//   Event:      u8 2, u32 ID, u64 ticks, u16 payload length, payload (see e_LogArgType and LogStringTruncated)
+		static std::ofstream anoptamin_alogf;
+		static char anoptamin_alogbuf[64 * 1024];
+		static std::atomic<bool> anoptamin_alogopen(0);
+		static uint32_t anoptamin_alognextid = 0, anoptamin_alogfirstid = 0;
+		static std::mutex BinLog_Mutex;
+		static c_LogDescriptor anoptamin_textdesc[] = {
+			{"{}", LOG_TRACE, {0}}, {"{}", LOG_DEBUG, {0}}, {"{}", LOG_COMMON, {0}}, {"{}", LOG_INFO, {0}},
+			{"{}", LOG_WARN, {0}}, {"{}", LOG_ERROR, {0}}, {"{}", LOG_FATAL, {0}}
+		};
+		
+		void FormatLogLine(std::string& out, e_LogSeverity SEV, uint64_t timediff, const std::string& MSG) {
+			static const char* const Labels[] = {
+				"[ TRACE  ] (+", "[ DEBUG  ] (+", "[ COMMON ] (+", "[  INFO  ] (+",
+				"[  WARN  ] (+", "[ ERROR  ] (+", "[ FATAL  ] (+"
+			};
+			out += Labels[SEV <= LOG_FATAL ? SEV : LOG_FATAL];
+			out += std::to_string(timediff);
+			out += ") ";
+			out += MSG;
+			out += '\n';
+		}
+		
+		//! Writes one event, and its descriptor if this file has not seen the call site yet. Caller holds BinLog_Mutex.
+		static void WriteBinaryLocked(c_LogDescriptor& D, const uint8_t* Codes, uint8_t Argc, const uint8_t* Data, uint16_t Len, uint64_t timediff) {
+			uint32_t ID = D.ID.load(std::memory_order_relaxed);
+			if (ID <= anoptamin_alogfirstid) {
+				ID = ++anoptamin_alognextid;
+				D.ID.store(ID, std::memory_order_relaxed);
+				const size_t FmtLen = std::strlen(D.Format);
+				const uint16_t FmtLen16 = uint16_t(FmtLen < 0xFFFF ? FmtLen : 0xFFFF);
+				uint8_t Desc[8];
+				Desc[0] = 1; std::memcpy(Desc + 1, &ID, 4); Desc[5] = D.Severity; Desc[6] = Argc;
+				anoptamin_alogf.write((const char*)Desc, 7);
+				anoptamin_alogf.write((const char*)Codes, Argc);
+				anoptamin_alogf.write((const char*)&FmtLen16, 2);
+				anoptamin_alogf.write(D.Format, FmtLen16);
+			}
+			uint8_t Head[15];
+			Head[0] = 2; std::memcpy(Head + 1, &ID, 4); std::memcpy(Head + 5, &timediff, 8); std::memcpy(Head + 13, &Len, 2);
+			anoptamin_alogf.write((const char*)Head, 15);
+			anoptamin_alogf.write((const char*)Data, Len);
+		}
+		
+		std::string RenderBinaryRecord(const char* Format, const uint8_t* Codes, uint8_t Argc, const uint8_t* Data, uint16_t Len) {
+			std::string out;
+			size_t pos = 0; uint8_t arg = 0;
+			for (const char* c = Format; *c != 0; c++) {
+				if (c[0] != '{' || c[1] != '}' || arg >= Argc) {
+					out += *c;
+					continue;
+				}
+				c++;
+				switch (Codes[arg++]) {
+					case LOGARG_INT: {
+						int64_t V = 0;
+						if (pos + 8 <= Len) std::memcpy(&V, Data + pos, 8);
+						out += std::to_string(V); pos += 8;
+						break;
+					}
+					case LOGARG_UINT: {
+						uint64_t V = 0;
+						if (pos + 8 <= Len) std::memcpy(&V, Data + pos, 8);
+						out += std::to_string(V); pos += 8;
+						break;
+					}
+					case LOGARG_FLOAT: {
+						double V = 0;
+						if (pos + 8 <= Len) std::memcpy(&V, Data + pos, 8);
+						out += std::to_string(V); pos += 8;
+						break;
+					}
+					case LOGARG_STRING: {
+						uint16_t N = LogStringTruncated; // Dropped entirely when there was no room for its length.
+						if (pos + 2 <= Len) std::memcpy(&N, Data + pos, 2);
+						const bool Truncated = (N & LogStringTruncated) != 0;
+						N &= ~LogStringTruncated;
+						pos += 2;
+						if (pos + N > Len) N = (pos < Len) ? uint16_t(Len - pos) : 0;
+						out.append((const char*)Data + pos, N); pos += N;
+						if (Truncated) out += "...[truncated]";
+						break;
+					}
+					default:
+						out += "{?}";
+						break;
+				};
+			}
+			return out;
+		}
+		
+		//! Microseconds since SetupFiles(), on the Base clock.
+		static inline uint64_t LogTimestamp() {
+			return Base::clockTicksToNanos(Base::clockTicks() - Base::anoptamin_stclock) / 1000;
+		}
+		
+		static bool RingPush(e_LogSeverity SEV, uint64_t timediff, std::string& MSG) {
+			size_t pos = anoptamin_logtail.load(std::memory_order_relaxed);
+			for (;;) {
+				c_LogSlot& S = anoptamin_logring[pos & anoptamin_logmask];
+				const size_t seq = S.Sequence.load(std::memory_order_acquire);
+				const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+				if (diff == 0) {
+					if (anoptamin_logtail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						S.Record.Severity = SEV;
+						S.Record.Timestamp = timediff;
+						S.Record.Message.swap(MSG);
+						S.Sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (diff < 0) {
+					return false; // Full
+				} else {
+					pos = anoptamin_logtail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+		
+		static bool RingPop(c_LogRecord& out) {
+			size_t pos = anoptamin_loghead.load(std::memory_order_relaxed);
+			for (;;) {
+				c_LogSlot& S = anoptamin_logring[pos & anoptamin_logmask];
+				const size_t seq = S.Sequence.load(std::memory_order_acquire);
+				const intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+				if (diff == 0) {
+					if (anoptamin_loghead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						out.Severity = S.Record.Severity;
+						out.Timestamp = S.Record.Timestamp;
+						out.Message.swap(S.Record.Message);
+						S.Sequence.store(pos + anoptamin_logmask + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (diff < 0) {
+					return false; // Empty
+				} else {
+					pos = anoptamin_loghead.load(std::memory_order_relaxed);
+				}
+			}
+		}
+		
+		//! Body of the writer thread. Drains the ring into one buffer, and pushes that out with a single write per batch.
+		//! Wakes the writer if it is waiting for records. Called after a push; the fences pair with the writer's, so
+		//! either it sees the record before it waits or we see it waiting, and the lock closes the gap before its wait.
+		static inline void WakeWriter() {
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!anoptamin_logsleeping.load(std::memory_order_relaxed)) return;
+			std::lock_guard<std::mutex> Guard(anoptamin_logwakelock);
+			anoptamin_logwake.notify_one();
+		}
+		
+		static void AsyncWriterLoop() {
+			anoptamin_logwriterid.store(std::this_thread::get_id());
+			std::string Batch; Batch.reserve(64 * 1024);
+			c_LogRecord R;
+			uint64_t lastDropped = anoptamin_logdropped.load(std::memory_order_relaxed);
+			
+			for (;;) {
+				const bool stopping = anoptamin_logstop.load(std::memory_order_acquire);
+				anoptamin_logbusy.store(1);
+				size_t count = 0;
+				while (count < 8192 && RingPop(R)) {
+					FormatLogLine(Batch, R.Severity, R.Timestamp, R.Message);
+					count++;
+				}
+				const uint64_t dropped = anoptamin_logdropped.load(std::memory_order_relaxed);
+				if (dropped != lastDropped) {
+					FormatLogLine(Batch, LOG_WARN, LogTimestamp(),
+						"Asynchronous logging dropped " + std::to_string(dropped - lastDropped) + " record(s).");
+					lastDropped = dropped;
+				}
+				if (!Batch.empty()) {
+					Log_Mutex.lock();
+					Base::anoptamin_logf.write(Batch.data(), Batch.size());
+					Base::anoptamin_logf.flush();
+					Log_Mutex.unlock();
+					Batch.clear();
+				}
+				anoptamin_logbusy.store(0);
+				
+				if (count == 0) {
+					if (stopping) break;
+					// Sleep until a producer pushes something (see WakeWriter) or we're told to stop.
+					std::unique_lock<std::mutex> L(anoptamin_logwakelock);
+					anoptamin_logsleeping.store(1, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					anoptamin_logwake.wait(L, []() {
+						return anoptamin_logstop.load() || anoptamin_logtail.load() != anoptamin_loghead.load();
+					});
+					anoptamin_logsleeping.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+		
+		// Wall clock time at SetupFiles, in microseconds since the Unix epoch. Record timestamps count from here.
+		static uint64_t anoptamin_startunix = 0;
+		
 		//! Sets up the session log file and gets the temporary files directory from the current directory.
 		void LIBANOP_FUNC_COLD SetupFiles() {
 			// The <filesystem> paths are supposed to be portable if in POSIX syntax
 			
-			Base::anoptamin_stclock = std::clock();
+			Base::anoptamin_stclock = Base::clockTicks();
+			anoptamin_startunix = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count());
 			
 			try {
 				Base::anoptamin_TMPpath = std::filesystem::temp_directory_path();
@@ -219,10 +918,12 @@ namespace Anoptamin {
 			Base::anoptamin_logf.open( Base::anoptamin_LOGpath.string(), std::ios::trunc );
 			assert_fileio( Base::anoptamin_logf.is_open() &&Base:: anoptamin_logf.good() );
 			Base::anoptamin_logopen = 1;
-			Base::anoptamin_logf << "ANOPTAMIN Log Created on " << datestr << " (Start +" << Base::anoptamin_stclock << ").\n" << std::flush;
+			Base::anoptamin_logf << "ANOPTAMIN Log Created on " << datestr << " (Start " << anoptamin_startunix << "us after the Unix epoch).\n" << std::flush;
 		}
 		
 		void LIBANOP_FUNC_COLD CleanupFiles() {
+			DisableAsyncLogging();
+			DisableBinaryLogging();
 			std::filesystem::remove_all( Base::anoptamin_TMPpath );
 			Base::anoptamin_logf.close();
 			Base::anoptamin_logopen = 0;
@@ -244,38 +945,195 @@ namespace Anoptamin {
 			LogTrace_Mutex.unlock();
 		}
 		
+		//! Puts a record on the ring under the overflow policy; false if it should be written synchronously instead.
+		static bool LIBANOP_FUNC_HOT QueueLog(e_LogSeverity SEV, uint64_t timediff, std::string& MSG) {
+			if (RingPush(SEV, timediff, MSG)) {
+				WakeWriter();
+				return true;
+			}
+			switch (anoptamin_logpolicy) {
+				case OVERFLOW_DROP_NEWEST:
+					anoptamin_logdropped.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				case OVERFLOW_DROP_OLDEST: {
+					c_LogRecord Old;
+					do {
+						if (!anoptamin_logasync.load(std::memory_order_acquire)) return false;
+						if (RingPop(Old)) anoptamin_logdropped.fetch_add(1, std::memory_order_relaxed);
+					} while (!RingPush(SEV, timediff, MSG));
+					WakeWriter();
+					return true;
+				}
+				default:
+					do {
+						// The writer is stopping; it won't make room, so fall back to writing it ourselves.
+						if (!anoptamin_logasync.load(std::memory_order_acquire)) return false;
+						WakeWriter();
+						std::this_thread::yield();
+					} while (!RingPush(SEV, timediff, MSG));
+					WakeWriter();
+					return true;
+			};
+		}
+		
+		//! Writes a record straight to the text log; only the text half of Log, so it never touches the .alog.
+		static void WriteLogText(e_LogSeverity SEV, uint64_t timediff, const std::string& MSG) {
+			// FATAL records must land after everything queued before them, and with the stacktrace right behind.
+			if (SEV == LOG_FATAL) FlushLogs();
+			
+			std::string Line;
+			FormatLogLine(Line, SEV, timediff, MSG);
+			Log_Mutex.lock();
+			Base::anoptamin_logf << Line << std::flush;
+			if (SEV == LOG_FATAL) LogTrace();
+			Log_Mutex.unlock();
+		}
+		
 		void LIBANOP_FUNC_HOT LIBANOP_FUNC_NOINLINE Log(e_LogSeverity SEV, std::string MSG) {
 			assert_runtime( Base::anoptamin_logopen );
+			uint64_t timediff = LogTimestamp();
+			
+			if (anoptamin_alogopen.load(std::memory_order_acquire)) {
+				static const uint8_t Code = LOGARG_STRING;
+				uint8_t Data[LogMaxPayload]; size_t pos = 0;
+				LogArgPackString(Data, pos, MSG.data(), MSG.size());
+				BinLog_Mutex.lock();
+				if (anoptamin_alogopen.load(std::memory_order_relaxed))
+					WriteBinaryLocked(anoptamin_textdesc[SEV <= LOG_FATAL ? SEV : LOG_FATAL], &Code, 1, Data, uint16_t(pos), timediff);
+				BinLog_Mutex.unlock();
+				if (SEV != LOG_FATAL) return;
+			}
+			
+			if (SEV != LOG_FATAL) {
+				// Counted before the switch is read, so DisableAsyncLogging can wait out anyone past it.
+				anoptamin_loginflight.fetch_add(1);
+				const bool Queued = anoptamin_logasync.load() && QueueLog(SEV, timediff, MSG);
+				anoptamin_loginflight.fetch_sub(1, std::memory_order_release);
+				if (Queued) return;
+			}
+			WriteLogText(SEV, timediff, MSG);
+		}
+		
+		void LIBANOP_FUNC_COLD EnableAsyncLogging(e_LogOverflow policy, size_t capacity) {
+			assert_runtime( Base::anoptamin_logopen );
+			check_param( capacity >= 2 && capacity <= (size_t(1) << 24) );
+			if (anoptamin_logasync.load()) DisableAsyncLogging();
+			
+			size_t RealCap = 2;
+			while (RealCap < capacity) RealCap <<= 1;
+			// Positions carry on from the last ring (which was drained), so a FlushLogs still waiting on one never sees them go back.
+			const size_t Start = anoptamin_logtail.load();
+			anoptamin_logring = new c_LogSlot[RealCap];
+			anoptamin_logmask = RealCap - 1;
+			for (size_t i = 0; i < RealCap; i++) anoptamin_logring[(Start + i) & anoptamin_logmask].Sequence.store(Start + i, std::memory_order_relaxed);
+			anoptamin_logpolicy = policy;
+			anoptamin_logstop.store(0);
+			
+			anoptamin_logwriter = new std::thread(AsyncWriterLoop);
+			anoptamin_logasync.store(1, std::memory_order_release);
+			Log(LOG_DEBUG, "Asynchronous logging enabled with " + std::to_string(RealCap) + " slots.");
+		}
+		
+		void LIBANOP_FUNC_COLD DisableAsyncLogging() {
+			if (!anoptamin_logasync.load()) return;
+			FlushLogs();
+			anoptamin_logasync.store(0);
+			// Producers that saw the switch still on may be mid-push; the ring has to outlive them.
+			while (anoptamin_loginflight.load() != 0) std::this_thread::yield();
+			{
+				std::lock_guard<std::mutex> Guard(anoptamin_logwakelock);
+				anoptamin_logstop.store(1, std::memory_order_release);
+			}
+			anoptamin_logwake.notify_one();
+			anoptamin_logwriterid.store(std::thread::id());
+			anoptamin_logwriter->join();
+			delete anoptamin_logwriter; anoptamin_logwriter = NULL;
+			
+			// Whatever the writer didn't get to before stopping is written from here.
+			c_LogRecord R; std::string Batch;
+			while (RingPop(R)) FormatLogLine(Batch, R.Severity, R.Timestamp, R.Message);
 			Log_Mutex.lock();
-			std::clock_t ntime = std::clock();
-			
-			uint64_t timediff = ntime - Base::anoptamin_stclock;
-			
-			switch (SEV) {
-				case LOG_TRACE:
-					Base::anoptamin_logf << "[ TRACE  ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					break;
-				case LOG_DEBUG:
-					Base::anoptamin_logf << "[ DEBUG  ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					break;
-				case LOG_COMMON:
-					Base::anoptamin_logf << "[ COMMON ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					break;
-				case LOG_INFO:
-					Base::anoptamin_logf << "[  INFO  ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					break;
-				case LOG_WARN:
-					Base::anoptamin_logf << "[  WARN  ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					break;
-				case LOG_ERROR:
-					Base::anoptamin_logf << "[ ERROR  ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					break;
-				case LOG_FATAL:
-					Base::anoptamin_logf << "[ FATAL  ] (+" << timediff << ") " << MSG << '\n' << std::flush;
-					LogTrace();
-					break;
-			};
+			Base::anoptamin_logf << Batch << std::flush;
+			Log_Mutex.unlock();
+			
+			delete[] anoptamin_logring; anoptamin_logring = NULL;
+		}
+		
+		void LIBANOP_FUNC_COLD FlushLogs() {
+			// Compares IDs rather than touching the std::thread, which DisableAsyncLogging may be deleting right now.
+			if (anoptamin_logasync.load(std::memory_order_acquire) && std::this_thread::get_id() != anoptamin_logwriterid.load()) {
+				const size_t target = anoptamin_logtail.load();
+				while (anoptamin_loghead.load() < target || anoptamin_logbusy.load()) {
+					WakeWriter();
+					std::this_thread::yield();
+				}
+			}
+			Log_Mutex.lock();
+			Base::anoptamin_logf.flush();
 			Log_Mutex.unlock();
+			BinLog_Mutex.lock();
+			if (anoptamin_alogopen.load()) anoptamin_alogf.flush();
+			BinLog_Mutex.unlock();
+		}
+		
+		LIBANOP_FUNC_EXPORT std::atomic<uint8_t> LogThreshold(LOG_TRACE);
+		
+		void SetLogThreshold(e_LogSeverity SEV) {
+			LogThreshold.store(SEV <= LOG_FATAL ? SEV : LOG_FATAL, std::memory_order_relaxed);
+		}
+		
+		uint64_t GetDroppedLogs() {
+			return anoptamin_logdropped.load(std::memory_order_relaxed);
+		}
+		
+		void LIBANOP_FUNC_COLD EnableBinaryLogging() {
+			assert_runtime( Base::anoptamin_logopen );
+			if (anoptamin_alogopen.load()) return;
+			
+			std::filesystem::path BinPath = Base::anoptamin_LOGpath;
+			BinPath.replace_extension(".alog");
+			anoptamin_alogf.rdbuf()->pubsetbuf(anoptamin_alogbuf, sizeof(anoptamin_alogbuf));
+			anoptamin_alogf.open( BinPath.string(), std::ios::trunc | std::ios::binary );
+			assert_fileio( anoptamin_alogf.is_open() && anoptamin_alogf.good() );
+			
+			std::time_t now = std::time(NULL);
+			char datestr[121]; datestr[120] = 0;
+			std::strftime(datestr, 120, "%A, %d %B %Y at %H:%M:%S", std::localtime( &now ));
+			const uint16_t Version = 1, DateLen = uint16_t(std::strlen(datestr));
+			const uint64_t Start = anoptamin_startunix;
+			anoptamin_alogf.write("ANOPALOG", 8);
+			anoptamin_alogf.write((const char*)&Version, 2);
+			anoptamin_alogf.write((const char*)&Start, 8);
+			anoptamin_alogf.write((const char*)&DateLen, 2);
+			anoptamin_alogf.write(datestr, DateLen);
+			
+			// Call sites registered for an older file get new IDs in this one.
+			anoptamin_alogfirstid = anoptamin_alognextid;
+			anoptamin_alogopen.store(1, std::memory_order_release);
+			Log(LOG_DEBUG, "Binary logging enabled at '" + BinPath.string() + "'.");
+		}
+		
+		void LIBANOP_FUNC_COLD DisableBinaryLogging() {
+			if (!anoptamin_alogopen.load()) return;
+			BinLog_Mutex.lock();
+			anoptamin_alogopen.store(0, std::memory_order_release);
+			anoptamin_alogf.flush();
+			anoptamin_alogf.close();
+			BinLog_Mutex.unlock();
+		}
+		
+		void LIBANOP_FUNC_HOT WriteBinaryRecord(c_LogDescriptor& D, const uint8_t* Codes, uint8_t Argc, const uint8_t* Data, uint16_t Len) {
+			if (!anoptamin_alogopen.load(std::memory_order_acquire)) {
+				Log(D.Severity, RenderBinaryRecord(D.Format, Codes, Argc, Data, Len));
+				return;
+			}
+			assert_runtime( Base::anoptamin_logopen );
+			const uint64_t timediff = LogTimestamp();
+			BinLog_Mutex.lock();
+			if (anoptamin_alogopen.load(std::memory_order_relaxed)) WriteBinaryLocked(D, Codes, Argc, Data, Len, timediff);
+			BinLog_Mutex.unlock();
+			// Still leave a readable crash record with the stacktrace, in the text log only.
+			if (D.Severity == LOG_FATAL) WriteLogText(LOG_FATAL, timediff, RenderBinaryRecord(D.Format, Codes, Argc, Data, Len));
 		}
 	}
 } // End Anoptamin namespace
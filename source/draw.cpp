@@ -0,0 +1,778 @@
+/********!
+ * @file  draw.cpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Backend code for 'include/draw.hpp'
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+
+#include "../include/draw.hpp"
+
+// SSE2 kernels are built whenever the compiler targets it (always, on x86-64). AVX2 kernels are built for x86 with GCC
+// or Clang, which can compile single functions for it; they only run if SDL finds AVX2 on the CPU.
+#if defined(__SSE2__)
+	#define LIBANOP_DRAW_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define LIBANOP_DRAW_SSE2 0
+#endif
+#if LIBANOP_GNU && (defined(__x86_64__) || defined(__i386__))
+	#define LIBANOP_DRAW_AVX2 1
+	#define LIBANOP_TARGET_AVX2 __attribute__((target("avx2")))
+	#include <immintrin.h>
+#else
+	#define LIBANOP_DRAW_AVX2 0
+#endif
+
+namespace Anoptamin { namespace Graphics {
+
+// Row kernels. Every instruction set gets a set, each drawing 'count' pixels of a single row (or of a whole view whose
+// rows are contiguous).
+struct c_DrawKernels {
+	void (*Fill)(uint32_t* dst, size_t count, uint32_t color);
+	void (*Copy)(uint32_t* dst, const uint32_t* src, size_t count);
+	void (*Keyed)(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key);
+	void (*Blend)(uint32_t* dst, const uint32_t* src, size_t count);
+	// Scaling: dst[i] = src[columns[i]]; dst[i] = a blend of src[left[i]] and src[right[i]] by weights[i] / 256; and dst[i]
+	// = a blend of a[i] and b[i] by weight / 256.
+	void (*Nearest)(uint32_t* dst, const uint32_t* src, const uint32_t* columns, size_t count);
+	void (*LerpColumns)(uint32_t* dst, const uint32_t* src, const uint32_t* left, const uint32_t* right, const uint16_t* weights,
+		size_t count);
+	void (*LerpRows)(uint32_t* dst, const uint32_t* a, const uint32_t* b, size_t count, uint32_t weight);
+};
+
+static constexpr uint32_t anoptamin_alphamask = 0xFF000000u, anoptamin_colormask = 0x00FFFFFFu;
+
+/* Scalar */
+
+static void FillScalar(uint32_t* dst, size_t count, uint32_t color) {
+	for (size_t i = 0; i < count; i++) dst[i] = color;
+}
+
+// Opaque copies are left to memcpy in every set: the C library already picks the widest copy loop the CPU supports,
+// and beats a hand-written one for long rows.
+static void CopyRow(uint32_t* dst, const uint32_t* src, size_t count) {
+	std::memcpy(dst, src, count * sizeof(uint32_t));
+}
+
+static void KeyedScalar(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key) {
+	key &= anoptamin_colormask;
+	for (size_t i = 0; i < count; i++) {
+		if ((src[i] & anoptamin_colormask) != key) dst[i] = src[i];
+	}
+}
+
+//! Blends one pixel. Each channel is (s * a + d * (255 - a) + 128) / 255, rounded exactly; (x + (x >> 8)) >> 8 divides
+//! by 255 for any x this can produce. The source alpha is taken as 255 in the sum, which gives a + d * (1 - a) for alpha.
+static inline uint32_t BlendPixel(uint32_t s, uint32_t d) {
+	const uint32_t A = s >> 24;
+	if (A == 255) return s;
+	if (A == 0) return d;
+	s |= anoptamin_alphamask;
+	uint32_t Out = 0;
+	for (uint8_t Shift = 0; Shift < 32; Shift += 8) {
+		const uint32_t X = ((s >> Shift) & 255) * A + ((d >> Shift) & 255) * (255 - A) + 128;
+		Out |= ((X + (X >> 8)) >> 8) << Shift;
+	}
+	return Out;
+}
+
+static void BlendScalar(uint32_t* dst, const uint32_t* src, size_t count) {
+	for (size_t i = 0; i < count; i++) dst[i] = BlendPixel(src[i], dst[i]);
+}
+
+static void NearestScalar(uint32_t* dst, const uint32_t* src, const uint32_t* columns, size_t count) {
+	for (size_t i = 0; i < count; i++) dst[i] = src[columns[i]];
+}
+
+//! Blends two pixels, each channel (a * (256 - w) + b * w + 128) >> 8. Two channels at a time: no sum can reach 65536,
+//! so none carries into the channel above.
+static inline uint32_t LerpPixel(uint32_t a, uint32_t b, uint32_t w) {
+	const uint32_t Inverse = 256 - w;
+	const uint32_t RB = ((a & 0x00FF00FFu) * Inverse + (b & 0x00FF00FFu) * w + 0x00800080u) >> 8;
+	const uint32_t AG = (((a >> 8) & 0x00FF00FFu) * Inverse + ((b >> 8) & 0x00FF00FFu) * w + 0x00800080u) >> 8;
+	return (RB & 0x00FF00FFu) | ((AG & 0x00FF00FFu) << 8);
+}
+
+static void LerpColumnsScalar(uint32_t* dst, const uint32_t* src, const uint32_t* left, const uint32_t* right, const uint16_t* weights,
+	size_t count) {
+	for (size_t i = 0; i < count; i++) dst[i] = LerpPixel(src[left[i]], src[right[i]], weights[i]);
+}
+
+static void LerpRowsScalar(uint32_t* dst, const uint32_t* a, const uint32_t* b, size_t count, uint32_t weight) {
+	for (size_t i = 0; i < count; i++) dst[i] = LerpPixel(a[i], b[i], weight);
+}
+
+/* SSE2: four pixels at a time */
+
+#if LIBANOP_DRAW_SSE2
+static void FillSSE2(uint32_t* dst, size_t count, uint32_t color) {
+	const __m128i C = _mm_set1_epi32(int32_t(color));
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(dst + i), C);
+	FillScalar(dst + i, count - i, color);
+}
+
+static void KeyedSSE2(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key) {
+	const __m128i Key = _mm_set1_epi32(int32_t(key & anoptamin_colormask));
+	const __m128i Mask = _mm_set1_epi32(int32_t(anoptamin_colormask));
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i S = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i D = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i Skip = _mm_cmpeq_epi32(_mm_and_si128(S, Mask), Key);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(Skip, D), _mm_andnot_si128(Skip, S)));
+	}
+	KeyedScalar(dst + i, src + i, count - i, key);
+}
+
+//! Blends two pixels, widened to 16 bits a channel, as BlendPixel does.
+static inline __m128i BlendWideSSE2(__m128i s, __m128i d, __m128i a) {
+	const __m128i Inverse = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	__m128i X = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, Inverse)), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(X, _mm_srli_epi16(X, 8)), 8);
+}
+
+static void BlendSSE2(uint32_t* dst, const uint32_t* src, size_t count) {
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i AlphaMask = _mm_set1_epi32(int32_t(anoptamin_alphamask));
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i S = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i Alpha = _mm_and_si128(S, AlphaMask);
+		// Sprites are mostly fully opaque or fully clear, which need no arithmetic.
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(Alpha, Zero)) == 0xFFFF) continue;
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(Alpha, AlphaMask)) == 0xFFFF) {
+			_mm_storeu_si128((__m128i*)(dst + i), S);
+			continue;
+		}
+		const __m128i D = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i Opaque = _mm_or_si128(S, AlphaMask);
+		const __m128i SLo = _mm_unpacklo_epi8(S, Zero), SHi = _mm_unpackhi_epi8(S, Zero);
+		// Spread each pixel's alpha (its fourth channel) over all four of its channels.
+		const __m128i ALo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(SLo, 0xFF), 0xFF);
+		const __m128i AHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(SHi, 0xFF), 0xFF);
+		const __m128i Lo = BlendWideSSE2(_mm_unpacklo_epi8(Opaque, Zero), _mm_unpacklo_epi8(D, Zero), ALo);
+		const __m128i Hi = BlendWideSSE2(_mm_unpackhi_epi8(Opaque, Zero), _mm_unpackhi_epi8(D, Zero), AHi);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(Lo, Hi));
+	}
+	BlendScalar(dst + i, src + i, count - i);
+}
+
+//! Blends two pixels, widened to 16 bits a channel, as LerpPixel does; 'w' holds each channel's weight.
+static inline __m128i LerpWideSSE2(__m128i a, __m128i b, __m128i w) {
+	const __m128i Inverse = _mm_sub_epi16(_mm_set1_epi16(256), w);
+	const __m128i X = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(a, Inverse), _mm_mullo_epi16(b, w)), _mm_set1_epi16(128));
+	return _mm_srli_epi16(X, 8);
+}
+
+// SSE2 has no gather, so the columns are loaded one at a time; the arithmetic is still four pixels at once.
+static void LerpColumnsSSE2(uint32_t* dst, const uint32_t* src, const uint32_t* left, const uint32_t* right, const uint16_t* weights,
+	size_t count) {
+	const __m128i Zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i A = _mm_set_epi32(int32_t(src[left[i + 3]]), int32_t(src[left[i + 2]]), int32_t(src[left[i + 1]]), int32_t(src[left[i]]));
+		const __m128i B = _mm_set_epi32(int32_t(src[right[i + 3]]), int32_t(src[right[i + 2]]), int32_t(src[right[i + 1]]), int32_t(src[right[i]]));
+		// Spread each pixel's weight over its four channels: w0 w0 w1 w1 w2 w2 w3 w3, then w0 x4 w1 x4 and w2 x4 w3 x4.
+		const __m128i W = _mm_loadl_epi64((const __m128i*)(weights + i));
+		const __m128i Pairs = _mm_unpacklo_epi16(W, W);
+		const __m128i Lo = LerpWideSSE2(_mm_unpacklo_epi8(A, Zero), _mm_unpacklo_epi8(B, Zero), _mm_unpacklo_epi32(Pairs, Pairs));
+		const __m128i Hi = LerpWideSSE2(_mm_unpackhi_epi8(A, Zero), _mm_unpackhi_epi8(B, Zero), _mm_unpackhi_epi32(Pairs, Pairs));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(Lo, Hi));
+	}
+	LerpColumnsScalar(dst + i, src, left + i, right + i, weights + i, count - i);
+}
+
+static void LerpRowsSSE2(uint32_t* dst, const uint32_t* a, const uint32_t* b, size_t count, uint32_t weight) {
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i W = _mm_set1_epi16(int16_t(weight));
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i A = _mm_loadu_si128((const __m128i*)(a + i));
+		const __m128i B = _mm_loadu_si128((const __m128i*)(b + i));
+		const __m128i Lo = LerpWideSSE2(_mm_unpacklo_epi8(A, Zero), _mm_unpacklo_epi8(B, Zero), W);
+		const __m128i Hi = LerpWideSSE2(_mm_unpackhi_epi8(A, Zero), _mm_unpackhi_epi8(B, Zero), W);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(Lo, Hi));
+	}
+	LerpRowsScalar(dst + i, a + i, b + i, count - i, weight);
+}
+#endif
+
+/* AVX2: eight pixels at a time */
+
+#if LIBANOP_DRAW_AVX2
+LIBANOP_TARGET_AVX2 static void FillAVX2(uint32_t* dst, size_t count, uint32_t color) {
+	const __m256i C = _mm256_set1_epi32(int32_t(color));
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) _mm256_storeu_si256((__m256i*)(dst + i), C);
+	FillScalar(dst + i, count - i, color);
+}
+
+LIBANOP_TARGET_AVX2 static void KeyedAVX2(uint32_t* dst, const uint32_t* src, size_t count, uint32_t key) {
+	const __m256i Key = _mm256_set1_epi32(int32_t(key & anoptamin_colormask));
+	const __m256i Mask = _mm256_set1_epi32(int32_t(anoptamin_colormask));
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i S = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i D = _mm256_loadu_si256((const __m256i*)(dst + i));
+		const __m256i Skip = _mm256_cmpeq_epi32(_mm256_and_si256(S, Mask), Key);
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(S, D, Skip));
+	}
+	KeyedScalar(dst + i, src + i, count - i, key);
+}
+
+LIBANOP_TARGET_AVX2 static inline __m256i BlendWideAVX2(__m256i s, __m256i d, __m256i a) {
+	const __m256i Inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+	__m256i X = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, Inverse)), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(X, _mm256_srli_epi16(X, 8)), 8);
+}
+
+LIBANOP_TARGET_AVX2 static void BlendAVX2(uint32_t* dst, const uint32_t* src, size_t count) {
+	const __m256i Zero = _mm256_setzero_si256();
+	const __m256i AlphaMask = _mm256_set1_epi32(int32_t(anoptamin_alphamask));
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i S = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i Alpha = _mm256_and_si256(S, AlphaMask);
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(Alpha, Zero)) == -1) continue;
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(Alpha, AlphaMask)) == -1) {
+			_mm256_storeu_si256((__m256i*)(dst + i), S);
+			continue;
+		}
+		const __m256i D = _mm256_loadu_si256((const __m256i*)(dst + i));
+		const __m256i Opaque = _mm256_or_si256(S, AlphaMask);
+		// Unpacking and packing both work within each 128-bit half, so the pixels come back out in order.
+		const __m256i SLo = _mm256_unpacklo_epi8(S, Zero), SHi = _mm256_unpackhi_epi8(S, Zero);
+		const __m256i ALo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(SLo, 0xFF), 0xFF);
+		const __m256i AHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(SHi, 0xFF), 0xFF);
+		const __m256i Lo = BlendWideAVX2(_mm256_unpacklo_epi8(Opaque, Zero), _mm256_unpacklo_epi8(D, Zero), ALo);
+		const __m256i Hi = BlendWideAVX2(_mm256_unpackhi_epi8(Opaque, Zero), _mm256_unpackhi_epi8(D, Zero), AHi);
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(Lo, Hi));
+	}
+	BlendScalar(dst + i, src + i, count - i);
+}
+
+LIBANOP_TARGET_AVX2 static void NearestAVX2(uint32_t* dst, const uint32_t* src, const uint32_t* columns, size_t count) {
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i Columns = _mm256_loadu_si256((const __m256i*)(columns + i));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_i32gather_epi32((const int*)src, Columns, 4));
+	}
+	NearestScalar(dst + i, src, columns + i, count - i);
+}
+
+LIBANOP_TARGET_AVX2 static inline __m256i LerpWideAVX2(__m256i a, __m256i b, __m256i w) {
+	const __m256i Inverse = _mm256_sub_epi16(_mm256_set1_epi16(256), w);
+	const __m256i X = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(a, Inverse), _mm256_mullo_epi16(b, w)), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(X, 8);
+}
+
+LIBANOP_TARGET_AVX2 static void LerpColumnsAVX2(uint32_t* dst, const uint32_t* src, const uint32_t* left, const uint32_t* right,
+	const uint16_t* weights, size_t count) {
+	const __m256i Zero = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i A = _mm256_i32gather_epi32((const int*)src, _mm256_loadu_si256((const __m256i*)(left + i)), 4);
+		const __m256i B = _mm256_i32gather_epi32((const int*)src, _mm256_loadu_si256((const __m256i*)(right + i)), 4);
+		// Unpacking takes pixels 0, 1 and 4, 5 (then 2, 3 and 6, 7), so the weights are spread the same way.
+		const __m256i W = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(weights + i)));
+		const __m256i Pairs = _mm256_or_si256(W, _mm256_slli_epi32(W, 16));
+		const __m256i Lo = LerpWideAVX2(_mm256_unpacklo_epi8(A, Zero), _mm256_unpacklo_epi8(B, Zero), _mm256_unpacklo_epi32(Pairs, Pairs));
+		const __m256i Hi = LerpWideAVX2(_mm256_unpackhi_epi8(A, Zero), _mm256_unpackhi_epi8(B, Zero), _mm256_unpackhi_epi32(Pairs, Pairs));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(Lo, Hi));
+	}
+	LerpColumnsScalar(dst + i, src, left + i, right + i, weights + i, count - i);
+}
+
+LIBANOP_TARGET_AVX2 static void LerpRowsAVX2(uint32_t* dst, const uint32_t* a, const uint32_t* b, size_t count, uint32_t weight) {
+	const __m256i Zero = _mm256_setzero_si256();
+	const __m256i W = _mm256_set1_epi16(int16_t(weight));
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i A = _mm256_loadu_si256((const __m256i*)(a + i));
+		const __m256i B = _mm256_loadu_si256((const __m256i*)(b + i));
+		const __m256i Lo = LerpWideAVX2(_mm256_unpacklo_epi8(A, Zero), _mm256_unpacklo_epi8(B, Zero), W);
+		const __m256i Hi = LerpWideAVX2(_mm256_unpackhi_epi8(A, Zero), _mm256_unpackhi_epi8(B, Zero), W);
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(Lo, Hi));
+	}
+	LerpRowsScalar(dst + i, a + i, b + i, count - i, weight);
+}
+#endif
+
+/* Dispatch */
+
+// Sets that were not built fall back on the next best one, so every entry can be called.
+static const c_DrawKernels anoptamin_drawkernels[DRAW_ISA_COUNT] = {
+	{FillScalar, CopyRow, KeyedScalar, BlendScalar, NearestScalar, LerpColumnsScalar, LerpRowsScalar},
+#if LIBANOP_DRAW_SSE2
+	{FillSSE2, CopyRow, KeyedSSE2, BlendSSE2, NearestScalar, LerpColumnsSSE2, LerpRowsSSE2},
+#else
+	{FillScalar, CopyRow, KeyedScalar, BlendScalar, NearestScalar, LerpColumnsScalar, LerpRowsScalar},
+#endif
+#if LIBANOP_DRAW_AVX2
+	{FillAVX2, CopyRow, KeyedAVX2, BlendAVX2, NearestAVX2, LerpColumnsAVX2, LerpRowsAVX2}
+#elif LIBANOP_DRAW_SSE2
+	{FillSSE2, CopyRow, KeyedSSE2, BlendSSE2, NearestScalar, LerpColumnsSSE2, LerpRowsSSE2}
+#else
+	{FillScalar, CopyRow, KeyedScalar, BlendScalar, NearestScalar, LerpColumnsScalar, LerpRowsScalar}
+#endif
+};
+
+static const char* const anoptamin_drawisanames[DRAW_ISA_COUNT] = {"scalar", "SSE2", "AVX2"};
+
+static e_Draw_ISA DetectDrawISA() {
+	#if LIBANOP_DRAW_AVX2
+		if (SDL_HasAVX2()) return DRAW_AVX2;
+	#endif
+	#if LIBANOP_DRAW_SSE2
+		if (SDL_HasSSE2()) return DRAW_SSE2;
+	#endif
+	return DRAW_SCALAR;
+}
+
+static const e_Draw_ISA anoptamin_drawbest = DetectDrawISA();
+static const c_DrawKernels* anoptamin_drawactive = &anoptamin_drawkernels[anoptamin_drawbest];
+
+LIBANOP_FUNC_CODEPT e_Draw_ISA getDrawISA() noexcept {
+	return e_Draw_ISA(anoptamin_drawactive - anoptamin_drawkernels);
+}
+LIBANOP_FUNC_CODEPT e_Draw_ISA getBestDrawISA() noexcept {
+	return anoptamin_drawbest;
+}
+LIBANOP_FUNC_CODEPT void setDrawISA(e_Draw_ISA isa) {
+	check_param( isa <= anoptamin_drawbest );
+	anoptamin_drawactive = &anoptamin_drawkernels[isa];
+}
+LIBANOP_FUNC_CODEPT const char* getDrawISAName(e_Draw_ISA isa) noexcept {
+	return (isa < DRAW_ISA_COUNT) ? anoptamin_drawisanames[isa] : "unknown";
+}
+
+/* Views */
+
+LIBANOP_FUNC_CODEPT c_PixelView c_PixelView::of(SDL_Surface* surface) {
+	check_ptr( surface != NULL && surface->pixels != NULL );
+	check_param( surface->format->BytesPerPixel == 4 && surface->pitch % 4 == 0 );
+	c_PixelView Out;
+	Out.Pixels = static_cast<uint32_t*>(surface->pixels);
+	Out.Width = surface->w;
+	Out.Height = surface->h;
+	Out.Pitch = surface->pitch / 4;
+	return Out;
+}
+
+LIBANOP_FUNC_CODEPT c_PixelView c_PixelView::sub(const SDL_Rect& rect) const noexcept {
+	const int64_t X0 = std::max<int64_t>(rect.x, 0), Y0 = std::max<int64_t>(rect.y, 0);
+	const int64_t X1 = std::min<int64_t>(int64_t(rect.x) + rect.w, Width), Y1 = std::min<int64_t>(int64_t(rect.y) + rect.h, Height);
+	c_PixelView Out;
+	if (X1 <= X0 || Y1 <= Y0) return Out;
+	Out.Pixels = this->row(int32_t(Y0)) + X0;
+	Out.Width = int32_t(X1 - X0);
+	Out.Height = int32_t(Y1 - Y0);
+	Out.Pitch = Pitch;
+	return Out;
+}
+
+//! Clips a blit of 'srcRect' of 'src' to 'dst' at x, y, into two views of the same size. Returns false if nothing is left.
+static bool ClipBlit(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y,
+	c_PixelView& from, c_PixelView& to) {
+	const SDL_Rect Asked = (srcRect == NULL) ? src.bounds() : *srcRect;
+	from = src.sub(Asked);
+	if (from.empty()) return false;
+	// Move the destination corner by however much of the source was clipped off the top left, then clip to the destination.
+	int64_t X = int64_t(x) + std::max(Asked.x, 0) - Asked.x, Y = int64_t(y) + std::max(Asked.y, 0) - Asked.y;
+	to = dst.sub({int32_t(X), int32_t(Y), from.Width, from.Height});
+	if (to.empty()) return false;
+	if (X < 0) from.Pixels -= X;
+	if (Y < 0) from.Pixels -= Y * from.Pitch;
+	from.Width = to.Width;
+	from.Height = to.Height;
+	return true;
+}
+
+//! Runs a row kernel over every row of two views of the same size.
+template <typename FuncT, typename... ArgT>
+static inline void EachRow(FuncT kernel, const c_PixelView& from, const c_PixelView& to, ArgT... args) {
+	if (from.Pitch == from.Width && to.Pitch == to.Width) {
+		kernel(to.Pixels, from.Pixels, size_t(to.Width) * size_t(to.Height), args...);
+		return;
+	}
+	for (int32_t y = 0; y < to.Height; y++) kernel(to.row(y), from.row(y), size_t(to.Width), args...);
+}
+
+/* Drawing */
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void fillRect(const c_PixelView& dst, const SDL_Rect* rect, uint32_t color) {
+	const c_PixelView To = (rect == NULL) ? dst : dst.sub(*rect);
+	if (To.empty()) return;
+	const auto Fill = anoptamin_drawactive->Fill;
+	if (To.Pitch == To.Width) {
+		Fill(To.Pixels, size_t(To.Width) * size_t(To.Height), color);
+		return;
+	}
+	for (int32_t y = 0; y < To.Height; y++) Fill(To.row(y), size_t(To.Width), color);
+}
+
+LIBANOP_FUNC_CODEPT void clear(const c_PixelView& dst, uint32_t color) {
+	fillRect(dst, NULL, color);
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void blit(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y) {
+	c_PixelView From, To;
+	if (ClipBlit(src, srcRect, dst, x, y, From, To)) EachRow(anoptamin_drawactive->Copy, From, To);
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void blitKeyed(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y,
+	uint32_t key) {
+	c_PixelView From, To;
+	if (ClipBlit(src, srcRect, dst, x, y, From, To)) EachRow(anoptamin_drawactive->Keyed, From, To, key);
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void blitBlended(const c_PixelView& src, const SDL_Rect* srcRect, const c_PixelView& dst, int32_t x, int32_t y) {
+	c_PixelView From, To;
+	if (ClipBlit(src, srcRect, dst, x, y, From, To)) EachRow(anoptamin_drawactive->Blend, From, To);
+}
+
+/* Scaling */
+
+//! Maps destination pixel 'i' of 'to' onto an axis of 'from' pixels, in 16.16 fixed point, with pixel centers lined up:
+//! gets where its center falls, less half a pixel, so the integer part is the source pixel at or before it. Each is
+//! worked out from scratch rather than by adding up a rounded step, which would drift by up to a pixel across the axis.
+static inline uint64_t ScalePosition(int32_t from, int32_t to, int32_t i) {
+	const uint64_t Center = ((uint64_t(2 * i + 1) * uint64_t(from)) << 16) / (2 * uint64_t(to));
+	return (Center > 32768) ? Center - 32768 : 0;
+}
+
+//! Gets the source pixel the center of destination pixel 'i' falls in.
+static inline uint32_t ScaleNearest(int32_t from, int32_t to, int32_t i) {
+	return uint32_t((uint64_t(2 * i + 1) * uint64_t(from)) / (2 * uint64_t(to)));
+}
+
+//! Gets the source pixels a bilinear sample at 'position' blends, and the weight (0 to 255) of the second.
+static inline void ScaleTaps(uint64_t position, int32_t from, uint32_t& first, uint32_t& second, uint16_t& weight) {
+	first = uint32_t(position >> 16);
+	weight = uint16_t((position >> 8) & 255);
+	if (first >= uint32_t(from - 1)) {
+		first = uint32_t(from - 1);
+		weight = 0;
+	}
+	second = std::min(first + 1, uint32_t(from - 1));
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void scale(const c_PixelView& src, const c_PixelView& dst, e_Scale_Filter filter) {
+	if (src.empty() || dst.empty()) return;
+	const c_DrawKernels& K = *anoptamin_drawactive;
+	if (src.Width == dst.Width && src.Height == dst.Height) {
+		EachRow(K.Copy, src, dst);
+		return;
+	}
+	const size_t Width = size_t(dst.Width);
+	
+	if (filter == SCALE_NEAREST) {
+		std::vector<uint32_t> Columns(Width);
+		for (int32_t x = 0; x < dst.Width; x++) Columns[x] = ScaleNearest(src.Width, dst.Width, x);
+		int32_t Last = -1;
+		for (int32_t y = 0; y < dst.Height; y++) {
+			const int32_t Row = int32_t(ScaleNearest(src.Height, dst.Height, y));
+			// Scaling up, most rows repeat the one above, which is a plain copy.
+			if (Row == Last) K.Copy(dst.row(y), dst.row(y - 1), Width);
+			else K.Nearest(dst.row(y), src.row(Row), Columns.data(), Width);
+			Last = Row;
+		}
+		return;
+	}
+	
+	// Bilinear, in two passes: each source row is scaled across once, into one of two cached rows, and every destination
+	// row blends the two cached rows around it.
+	std::vector<uint32_t> Left(Width), Right(Width);
+	std::vector<uint16_t> Weights(Width);
+	for (int32_t x = 0; x < dst.Width; x++) ScaleTaps(ScalePosition(src.Width, dst.Width, x), src.Width, Left[x], Right[x], Weights[x]);
+	std::vector<uint32_t> Rows[2] = {std::vector<uint32_t>(Width), std::vector<uint32_t>(Width)};
+	int32_t Cached[2] = {-1, -1};
+	auto Across = [&](int32_t row, int32_t keep) -> const uint32_t* {
+		for (uint8_t k = 0; k < 2; k++) {
+			if (Cached[k] == row) return Rows[k].data();
+		}
+		const uint8_t Slot = (Cached[0] == keep) ? 1 : 0;
+		K.LerpColumns(Rows[Slot].data(), src.row(row), Left.data(), Right.data(), Weights.data(), Width);
+		Cached[Slot] = row;
+		return Rows[Slot].data();
+	};
+	for (int32_t y = 0; y < dst.Height; y++) {
+		uint32_t Top, Bottom;
+		uint16_t Weight;
+		ScaleTaps(ScalePosition(src.Height, dst.Height, y), src.Height, Top, Bottom, Weight);
+		const uint32_t* A = Across(int32_t(Top), int32_t(Bottom));
+		if (Weight == 0) {
+			K.Copy(dst.row(y), A, Width);
+			continue;
+		}
+		const uint32_t* B = Across(int32_t(Bottom), int32_t(Top));
+		K.LerpRows(dst.row(y), A, B, Width, Weight);
+	}
+}
+
+/* Dirty regions */
+
+static inline uint64_t RectArea(const SDL_Rect& r) {
+	return uint64_t(r.w) * uint64_t(r.h);
+}
+
+static inline SDL_Rect RectUnion(const SDL_Rect& a, const SDL_Rect& b) {
+	const int32_t X0 = std::min(a.x, b.x), Y0 = std::min(a.y, b.y);
+	return {X0, Y0, std::max(a.x + a.w, b.x + b.w) - X0, std::max(a.y + a.h, b.y + b.h) - Y0};
+}
+
+//! Gets how many pixels the bounding box of two rectangles covers which neither of them does.
+static inline int64_t MergeWaste(const SDL_Rect& a, const SDL_Rect& b) {
+	const int64_t Overlap = int64_t(std::max(0, std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x)))
+		* int64_t(std::max(0, std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y)));
+	return int64_t(RectArea(RectUnion(a, b))) - int64_t(RectArea(a)) - int64_t(RectArea(b)) + Overlap;
+}
+
+LIBANOP_FUNC_CODEPT void c_DirtyRegion::setBounds(int32_t width, int32_t height) {
+	check_param( width >= 0 && height >= 0 );
+	this->m_bounds = {0, 0, width, height};
+	this->addAll();
+}
+
+LIBANOP_FUNC_CODEPT void c_DirtyRegion::setMergeCost(uint32_t pixels, uint16_t maxRects) {
+	check_param( maxRects != 0 );
+	this->m_mergeCost = pixels;
+	this->m_maxRects = maxRects;
+}
+
+LIBANOP_FUNC_CODEPT void c_DirtyRegion::collapse() {
+	size_t BestA = 0, BestB = 1;
+	int64_t BestWaste = INT64_MAX;
+	for (size_t a = 0; a < this->m_rects.size(); a++) {
+		for (size_t b = a + 1; b < this->m_rects.size(); b++) {
+			const int64_t Waste = MergeWaste(this->m_rects[a], this->m_rects[b]);
+			if (Waste < BestWaste) {
+				BestWaste = Waste;
+				BestA = a;
+				BestB = b;
+			}
+		}
+	}
+	const SDL_Rect Merged = RectUnion(this->m_rects[BestA], this->m_rects[BestB]);
+	this->m_rects.erase(this->m_rects.begin() + BestB);
+	this->m_rects.erase(this->m_rects.begin() + BestA);
+	this->add(Merged);
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void c_DirtyRegion::add(const SDL_Rect& rect) {
+	if (this->m_full) return;
+	SDL_Rect Next;
+	if (!SDL_IntersectRect(&rect, &this->m_bounds, &Next)) return;
+	
+	// Absorb every rectangle that is cheap to merge with; each merge grows the new one, so rescan until none are left.
+	for (size_t i = 0; i < this->m_rects.size();) {
+		if (MergeWaste(this->m_rects[i], Next) <= int64_t(this->m_mergeCost)) {
+			Next = RectUnion(this->m_rects[i], Next);
+			this->m_rects[i] = this->m_rects.back();
+			this->m_rects.pop_back();
+			i = 0;
+		} else {
+			i++;
+		}
+	}
+	this->m_rects.push_back(Next);
+	
+	if (RectArea(Next) == RectArea(this->m_bounds)) {
+		this->addAll();
+		return;
+	}
+	if (this->m_rects.size() > this->m_maxRects) {
+		this->collapse();
+		return;
+	}
+	this->m_area = 0;
+	for (const SDL_Rect& R : this->m_rects) this->m_area += RectArea(R);
+}
+
+LIBANOP_FUNC_CODEPT void c_DirtyRegion::addAll() noexcept {
+	if (RectArea(this->m_bounds) == 0) return this->clear();
+	this->m_rects.assign(1, this->m_bounds);
+	this->m_area = RectArea(this->m_bounds);
+	this->m_full = 1;
+}
+
+LIBANOP_FUNC_CODEPT void c_DirtyRegion::clear() noexcept {
+	this->m_rects.clear();
+	this->m_area = 0;
+	this->m_full = 0;
+}
+
+LIBANOP_FUNC_CODEPT double c_DirtyRegion::getCoverage() const noexcept {
+	const uint64_t Bounds = RectArea(this->m_bounds);
+	return (Bounds == 0) ? 0 : double(this->m_area) / double(Bounds);
+}
+
+/* Tiled rendering */
+
+static constexpr SDL_Rect anoptamin_everywhere = {INT32_MIN / 2, INT32_MIN / 2, INT32_MAX, INT32_MAX}; // Covers any target.
+
+LIBANOP_FUNC_CODEPT c_TiledRenderer::c_TiledRenderer(int32_t tileWidth, int32_t tileHeight, Base::c_WorkerPool* pool) {
+	check_param( tileWidth > 0 && tileHeight > 0 );
+	this->m_tileWidth = tileWidth;
+	this->m_tileHeight = tileHeight;
+	this->mp_pool = (pool == NULL) ? &Base::c_WorkerPool::getShared() : pool;
+}
+
+LIBANOP_FUNC_CODEPT uint16_t c_TiledRenderer::getThreads() const noexcept {
+	const uint16_t Most = this->mp_pool->getThreadCount() + 1;
+	return (this->m_threads == 0 || this->m_threads > Most) ? Most : this->m_threads;
+}
+
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::record(const c_Command& command) {
+	if (command.Area.w <= 0 || command.Area.h <= 0) return;
+	this->m_commands.push_back(command);
+}
+
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::fillRect(const SDL_Rect* rect, uint32_t color) {
+	c_Command C = {};
+	C.Kind = COMMAND_FILL;
+	C.Area = (rect == NULL) ? anoptamin_everywhere : *rect;
+	C.Color = color;
+	this->record(C);
+}
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::clear(uint32_t color) {
+	this->fillRect(NULL, color);
+}
+
+//! Records a blit. The area is that of the clipped source, so it covers no more than the blit will draw.
+static inline void MakeBlit(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y, SDL_Rect& area, c_PixelView& source,
+	SDL_Rect& sourceRect) {
+	const SDL_Rect Asked = (srcRect == NULL) ? src.bounds() : *srcRect;
+	const c_PixelView Clipped = src.sub(Asked);
+	area = {x + std::max(Asked.x, 0) - Asked.x, y + std::max(Asked.y, 0) - Asked.y, Clipped.Width, Clipped.Height};
+	source = Clipped;
+	sourceRect = Clipped.bounds();
+}
+
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::blit(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y) {
+	c_Command C = {};
+	C.Kind = COMMAND_BLIT;
+	MakeBlit(src, srcRect, x, y, C.Area, C.Source, C.SourceRect);
+	this->record(C);
+}
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::blitKeyed(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y, uint32_t key) {
+	c_Command C = {};
+	C.Kind = COMMAND_BLIT_KEYED;
+	C.Color = key;
+	MakeBlit(src, srcRect, x, y, C.Area, C.Source, C.SourceRect);
+	this->record(C);
+}
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::blitBlended(const c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y) {
+	c_Command C = {};
+	C.Kind = COMMAND_BLIT_BLENDED;
+	MakeBlit(src, srcRect, x, y, C.Area, C.Source, C.SourceRect);
+	this->record(C);
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void c_TiledRenderer::drawTile(uint32_t tile) {
+	const SDL_Rect Bounds = {int32_t(tile % uint32_t(this->m_tilesAcross)) * this->m_tileWidth,
+		int32_t(tile / uint32_t(this->m_tilesAcross)) * this->m_tileHeight, this->m_tileWidth, this->m_tileHeight};
+	const c_PixelView View = this->m_target.sub(Bounds);
+	for (uint32_t i = this->m_binOffsets[tile]; i < this->m_binOffsets[tile + 1]; i++) {
+		const c_Command& C = this->m_commands[this->m_bins[i]];
+		const int32_t X = C.Area.x - Bounds.x, Y = C.Area.y - Bounds.y;
+		switch (C.Kind) {
+			case COMMAND_FILL: {
+				const SDL_Rect Local = {X, Y, C.Area.w, C.Area.h};
+				Graphics::fillRect(View, &Local, C.Color);
+				break;
+			}
+			case COMMAND_BLIT: Graphics::blit(C.Source, &C.SourceRect, View, X, Y); break;
+			case COMMAND_BLIT_KEYED: Graphics::blitKeyed(C.Source, &C.SourceRect, View, X, Y, C.Color); break;
+			case COMMAND_BLIT_BLENDED: Graphics::blitBlended(C.Source, &C.SourceRect, View, X, Y); break;
+		}
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::drawTiles() {
+	for (;;) {
+		const uint32_t Tile = this->m_nextTile.fetch_add(1, std::memory_order_relaxed);
+		if (Tile >= this->m_tileCount) return;
+		this->drawTile(Tile);
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::helperTask(void* renderer) {
+	c_TiledRenderer* R = static_cast<c_TiledRenderer*>(renderer);
+	R->drawTiles();
+	R->m_helpersLeft.fetch_sub(1, std::memory_order_release);
+}
+
+LIBANOP_FUNC_CODEPT void c_TiledRenderer::flush(const c_PixelView& target, c_DirtyRegion* dirty) {
+	if (this->m_commands.empty() || target.empty()) {
+		this->m_commands.clear();
+		return;
+	}
+	this->m_target = target;
+	this->m_tilesAcross = (target.Width + this->m_tileWidth - 1) / this->m_tileWidth;
+	const int32_t TilesDown = (target.Height + this->m_tileHeight - 1) / this->m_tileHeight;
+	this->m_tileCount = uint32_t(this->m_tilesAcross) * uint32_t(TilesDown);
+	
+	// Bin the commands: count what lands in each tile, turn the counts into offsets, then fill the bins in order.
+	std::vector<SDL_Rect> Spans(this->m_commands.size()); // Tile columns and rows each command covers, as x0, y0, x1, y1.
+	this->m_binOffsets.assign(this->m_tileCount + 1, 0);
+	const SDL_Rect Whole = target.bounds();
+	for (size_t i = 0; i < this->m_commands.size(); i++) {
+		SDL_Rect Drawn;
+		if (!SDL_IntersectRect(&this->m_commands[i].Area, &Whole, &Drawn)) {
+			Spans[i] = {0, 0, 0, 0};
+			continue;
+		}
+		if (dirty != NULL) dirty->add(Drawn);
+		Spans[i] = {Drawn.x / this->m_tileWidth, Drawn.y / this->m_tileHeight,
+			(Drawn.x + Drawn.w - 1) / this->m_tileWidth + 1, (Drawn.y + Drawn.h - 1) / this->m_tileHeight + 1};
+		for (int32_t ty = Spans[i].y; ty < Spans[i].h; ty++) {
+			for (int32_t tx = Spans[i].x; tx < Spans[i].w; tx++) this->m_binOffsets[ty * this->m_tilesAcross + tx + 1]++;
+		}
+	}
+	for (uint32_t t = 0; t < this->m_tileCount; t++) this->m_binOffsets[t + 1] += this->m_binOffsets[t];
+	this->m_bins.resize(this->m_binOffsets[this->m_tileCount]);
+	std::vector<uint32_t> Fill(this->m_binOffsets.begin(), this->m_binOffsets.end() - 1);
+	for (size_t i = 0; i < this->m_commands.size(); i++) {
+		for (int32_t ty = Spans[i].y; ty < Spans[i].h; ty++) {
+			for (int32_t tx = Spans[i].x; tx < Spans[i].w; tx++) this->m_bins[Fill[ty * this->m_tilesAcross + tx]++] = uint32_t(i);
+		}
+	}
+	
+	// Draw. The calling thread draws too, then helps with other pool work until the helpers have all finished.
+	const uint16_t Helpers = uint16_t(std::min<uint32_t>(this->getThreads() - 1, this->m_tileCount - 1));
+	this->m_nextTile.store(0, std::memory_order_relaxed);
+	this->m_helpersLeft.store(Helpers, std::memory_order_relaxed);
+	for (uint16_t i = 0; i < Helpers; i++) this->mp_pool->submit(helperTask, this);
+	this->drawTiles();
+	while (this->m_helpersLeft.load(std::memory_order_acquire) != 0) {
+		if (!this->mp_pool->runOne()) std::this_thread::yield();
+	}
+	this->m_commands.clear();
+}
+
+}} // End Anoptamin::Graphics
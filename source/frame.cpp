@@ -0,0 +1,277 @@
+/********!
+ * @file  frame.cpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Backend code for 'include/frame.hpp'
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+
+#include "../include/frame.hpp"
+
+namespace Anoptamin { namespace Base {
+
+// Bounds on how early pacing stops sleeping and starts spinning.
+static constexpr uint64_t anoptamin_spinleast = 50000, anoptamin_spinmost = 4000000;
+
+static const char* const anoptamin_phasenames[PHASE_COUNT] = {"poll", "hooks", "update", "render", "present", "sleep"};
+
+// How far into the frame budget the resolution controller lets the work get before scaling down, where it aims, and how
+// far under it must be to scale back up.
+static constexpr double anoptamin_loadhigh = 0.9, anoptamin_loadaim = 0.8, anoptamin_loadlow = 0.65;
+
+LIBANOP_FUNC_CODEPT c_ResolutionController::c_ResolutionController(double targetFPS, float minScale, float maxScale) {
+	this->m_scale = maxScale;
+	this->setTargetFPS(targetFPS);
+	this->setLimits(minScale, maxScale);
+}
+
+LIBANOP_FUNC_CODEPT void c_ResolutionController::setTargetFPS(double fps) {
+	check_param( fps > 0 && fps <= 100000 );
+	this->m_budgetNanos = uint64_t(1e9 / fps);
+}
+
+LIBANOP_FUNC_CODEPT void c_ResolutionController::setLimits(float minScale, float maxScale) {
+	check_param( minScale > 0 && minScale <= maxScale && maxScale <= 1 );
+	this->m_minScale = minScale;
+	this->m_maxScale = maxScale;
+	this->m_scale = std::min(std::max(this->m_scale, minScale), maxScale);
+}
+
+LIBANOP_FUNC_CODEPT bool c_ResolutionController::update(uint64_t workNanos) {
+	if (this->m_average == 0) this->m_average = double(workNanos);
+	else this->m_average += (double(workNanos) - this->m_average) / 10;
+	if (this->m_settle != 0) {
+		this->m_settle--;
+		return false;
+	}
+	
+	const double Load = this->m_average / double(this->m_budgetNanos);
+	double Want = this->m_scale;
+	if (Load > anoptamin_loadhigh) Want = this->m_scale * std::sqrt(anoptamin_loadaim / Load);
+	else if (Load < anoptamin_loadlow) Want = std::min(this->m_scale * std::sqrt(anoptamin_loadaim / Load), this->m_scale + 1.0 / 16);
+	const float Next = std::min(std::max(float(std::floor(Want * 32) / 32), this->m_minScale), this->m_maxScale);
+	if (Next == this->m_scale) return false;
+	
+	// Guess the work at the new scale, so the average does not have to climb (or fall) all the way there first.
+	this->m_average *= double(Next) * double(Next) / (double(this->m_scale) * double(this->m_scale));
+	this->m_settle = (Next < this->m_scale) ? 8 : 30;
+	this->m_scale = Next;
+	return true;
+}
+
+LIBANOP_FUNC_CODEPT void c_ResolutionController::reset() noexcept {
+	this->m_average = 0;
+	this->m_settle = 0;
+}
+
+LIBANOP_FUNC_CODEPT c_FrameScheduler::c_FrameScheduler(c_SDLWindow* window, double tickRate) {
+	check_ptr( window != NULL );
+	this->mp_window = window;
+	this->setTickRate(tickRate);
+	this->m_present = [window]() {
+		if (window->isRenderThreadRunning()) window->presentRendered(); else window->refreshWindowSurface();
+	};
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setUpdate(t_UpdateFunc func) {
+	this->m_update = std::move(func);
+}
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setRender(t_RenderFunc func) {
+	this->m_render = std::move(func);
+}
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setPresent(t_PresentFunc func) {
+	this->m_present = std::move(func);
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setTickRate(double tickRate) {
+	check_param( tickRate > 0 && tickRate <= 100000 );
+	this->m_tickNanos = uint64_t(1e9 / tickRate);
+}
+LIBANOP_FUNC_CODEPT double c_FrameScheduler::getTickRate() const noexcept {
+	return 1e9 / double(this->m_tickNanos);
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setTargetFPS(double fps) {
+	check_param( fps >= 0 && fps <= 100000 );
+	this->m_frameNanos = (fps == 0) ? 0 : uint64_t(1e9 / fps);
+	this->m_resolution.setTargetFPS((fps == 0) ? 60 : fps);
+}
+LIBANOP_FUNC_CODEPT double c_FrameScheduler::getTargetFPS() const noexcept {
+	return (this->m_frameNanos == 0) ? 0 : 1e9 / double(this->m_frameNanos);
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::syncToDisplay() {
+	SDL_DisplayMode Mode;
+	const int32_t Display = SDL_GetWindowDisplayIndex(this->mp_window->getRawSDLWindow());
+	if (Display >= 0 && SDL_GetCurrentDisplayMode(Display, &Mode) == 0 && Mode.refresh_rate > 0) {
+		this->setTargetFPS(Mode.refresh_rate);
+	} else {
+		Anoptamin_LogDebug("Could not get the display refresh rate; pacing to 60 FPS.");
+		this->setTargetFPS(60);
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setMaxTicksPerFrame(uint16_t count) {
+	check_param( count != 0 );
+	this->m_maxTicks = count;
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::setDynamicResolution(bool enabled, float minScale, float maxScale) {
+	this->m_resolution.setLimits(minScale, maxScale);
+	this->m_resolution.reset();
+	this->m_dynamicResolution = enabled;
+	const Graphics::e_Scale_Filter Filter = this->mp_window->getScaleFilter();
+	this->mp_window->setRenderScale(enabled ? this->m_resolution.getScale() : 1, Filter);
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::pace() {
+	uint64_t Now = clockNanos();
+	this->m_nextFrame += this->m_frameNanos;
+	if (this->m_nextFrame <= Now) {
+		// Behind; start the next frame now, and keep the grid from there rather than rushing frames out to catch up.
+		this->m_nextFrame = Now;
+		return;
+	}
+	
+	if (this->m_nextFrame - Now > this->m_spinNanos) {
+		const uint64_t Ask = this->m_nextFrame - Now - this->m_spinNanos;
+		std::this_thread::sleep_for(std::chrono::nanoseconds(Ask));
+		const uint64_t Slept = clockNanos() - Now;
+		const uint64_t Want = std::min(std::max((Slept > Ask) ? (Slept - Ask) * 5 / 4 : 0, anoptamin_spinleast), anoptamin_spinmost);
+		// Jump straight up to cover a worse overshoot, and creep back down as the sleeps get more accurate.
+		if (Want > this->m_spinNanos) this->m_spinNanos = Want; else this->m_spinNanos -= (this->m_spinNanos - Want) / 32;
+	}
+	while (clockNanos() < this->m_nextFrame) {
+		#if LIBANOP_CLOCK_TSC
+			_mm_pause();
+		#else
+			std::this_thread::yield();
+		#endif
+	}
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT bool c_FrameScheduler::frame() {
+	if (!this->mp_window->isOpen()) return false;
+	
+	c_FrameTiming T;
+	T.Frame = this->m_frameCount;
+	const uint64_t Start = clockNanos();
+	const uint64_t Elapsed = (this->m_frameStart == 0) ? 0 : Start - this->m_frameStart;
+	if (this->m_frameStart == 0) this->m_nextFrame = Start;
+	this->m_frameStart = Start;
+	uint64_t Mark = Start;
+	auto EndPhase = [&T, &Mark](e_Frame_Phase phase) {
+		const uint64_t Now = clockNanos();
+		T.PhaseNanos[phase] = Now - Mark;
+		Mark = Now;
+	};
+	
+	const uint32_t Flags = SDL_GetWindowFlags(this->mp_window->getRawSDLWindow());
+	T.Idle = (Flags & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED));
+	if (T.Idle) this->mp_window->waitEvents(); else this->mp_window->pollEvents();
+	EndPhase(PHASE_POLL);
+	T.PhaseNanos[PHASE_HOOKS] = std::min(this->mp_window->getLastHookNanos(), T.PhaseNanos[PHASE_POLL]);
+	T.PhaseNanos[PHASE_POLL] -= T.PhaseNanos[PHASE_HOOKS];
+	
+	if (T.Idle || !this->mp_window->isOpen()) {
+		// Nothing is shown, so nothing is simulated; the game picks up where it left off once the window comes back.
+		this->m_accumulator = 0;
+		this->m_frameStart = 0;
+	} else {
+		this->m_accumulator += Elapsed;
+		uint64_t Ticks = this->m_accumulator / this->m_tickNanos;
+		if (Ticks > this->m_maxTicks) {
+			Ticks = this->m_maxTicks;
+			this->m_accumulator %= this->m_tickNanos;
+		} else {
+			this->m_accumulator -= Ticks * this->m_tickNanos;
+		}
+		T.Ticks = uint16_t(Ticks);
+		if (this->m_update) {
+			const double Dt = double(this->m_tickNanos) * 1e-9;
+			for (uint64_t i = 0; i < Ticks; i++) this->m_update(Dt);
+		}
+		EndPhase(PHASE_UPDATE);
+	
+		T.Alpha = double(this->m_accumulator) / double(this->m_tickNanos);
+		if (this->m_render) this->m_render(T.Alpha);
+		EndPhase(PHASE_RENDER);
+		if (this->m_present && this->mp_window->isOpen()) {
+			this->m_present();
+			// For presents other than refreshWindowSurface; a no-op after one. With a render thread, only a frame
+			// presentRendered actually showed counts.
+			if (!this->mp_window->isRenderThreadRunning()) this->mp_window->markPresented();
+		}
+		EndPhase(PHASE_PRESENT);
+		
+		if (this->m_dynamicResolution && this->mp_window->isOpen()) {
+			const uint64_t Work = this->mp_window->isRenderThreadRunning() ? this->mp_window->getRenderStats().LastRenderNanos
+				: T.PhaseNanos[PHASE_UPDATE] + T.PhaseNanos[PHASE_RENDER] + T.PhaseNanos[PHASE_PRESENT];
+			if (this->m_resolution.update(Work)) this->mp_window->setRenderScale(this->m_resolution.getScale(), this->mp_window->getScaleFilter());
+		}
+	
+		if (this->m_frameNanos != 0) this->pace();
+		EndPhase(PHASE_SLEEP);
+	}
+	T.FrameNanos = Mark - Start;
+	
+	for (uint8_t i = 0; i < PHASE_COUNT; i++) this->m_phaseLatency[i].record(T.PhaseNanos[i]);
+	this->m_frameLatency.record(T.FrameNanos);
+	this->m_last = T;
+	this->m_frameCount++;
+	return this->mp_window->isOpen();
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::run(uint64_t maxFrames) {
+	this->m_running = 1;
+	for (uint64_t i = 0; this->m_running && (maxFrames == 0 || i < maxFrames); i++) {
+		if (!this->frame()) break;
+	}
+	this->m_running = 0;
+}
+
+LIBANOP_FUNC_CODEPT c_LatencySummary c_FrameScheduler::getPhaseSummary(e_Frame_Phase phase) const {
+	check_bounds( phase < PHASE_COUNT );
+	return this->m_phaseLatency[phase].getSummary();
+}
+LIBANOP_FUNC_CODEPT c_LatencySummary c_FrameScheduler::getFrameSummary() const {
+	return this->m_frameLatency.getSummary();
+}
+
+LIBANOP_FUNC_CODEPT void c_FrameScheduler::resetTiming() {
+	for (c_LatencyHistogram& H : this->m_phaseLatency) H.reset();
+	this->m_frameLatency.reset();
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_COLD void c_FrameScheduler::logTimingReport() const {
+	const c_LatencySummary Frames = this->m_frameLatency.getSummary();
+	Anoptamin_LogInfoF("Frame timing over {} frames (ns): p50 {}, p99 {}, max {}", Frames.Count, Frames.P50, Frames.P99, Frames.Max);
+	for (uint8_t i = 0; i < PHASE_COUNT; i++) {
+		const c_LatencySummary L = this->m_phaseLatency[i].getSummary();
+		Anoptamin_LogInfoF("  {}: p50 {}, p99 {}, max {}", anoptamin_phasenames[i], L.P50, L.P99, L.Max);
+	}
+}
+
+}} // End Anoptamin::Base
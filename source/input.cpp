@@ -0,0 +1,227 @@
+/********!
+ * @file  input.cpp
+ * 
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ * 
+ * @date
+ * 	16 October 2026
+ * 
+ * @brief
+ * 	Backend code for 'include/input.hpp'
+ * 
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ * 
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ * 
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ * 
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ * 
+ ********/
+
+
+#include "../include/input.hpp"
+
+namespace Anoptamin { namespace Base {
+
+static void FillChord(c_InputBinding& out, std::initializer_list<SDL_Scancode> chord) {
+	check_param( chord.size() <= c_InputBinding::MaxChord );
+	uint8_t i = 0;
+	for (SDL_Scancode X : chord) out.Chord[i++] = X;
+}
+
+LIBANOP_FUNC_CODEPT c_InputBinding c_InputBinding::key(SDL_Scancode what, std::initializer_list<SDL_Scancode> chord) {
+	check_param( uint32_t(what) < SDL_NUM_SCANCODES );
+	c_InputBinding Out;
+	Out.Source = SOURCE_KEY;
+	Out.Code = what;
+	FillChord(Out, chord);
+	return Out;
+}
+LIBANOP_FUNC_CODEPT c_InputBinding c_InputBinding::mouseButton(uint8_t button, std::initializer_list<SDL_Scancode> chord) {
+	check_param( button != 0 && button < 8 );
+	c_InputBinding Out;
+	Out.Source = SOURCE_MOUSE_BUTTON;
+	Out.Code = button;
+	FillChord(Out, chord);
+	return Out;
+}
+LIBANOP_FUNC_CODEPT bool c_InputBinding::operator==(const c_InputBinding& b) const noexcept {
+	if (Source != b.Source || Code != b.Code) return false;
+	for (uint8_t i = 0; i < MaxChord; i++) {
+		if (Chord[i] != b.Chord[i]) return false;
+	}
+	return true;
+}
+
+LIBANOP_FUNC_CODEPT c_ActionMap::c_ActionMap() {
+	for (uint16_t& X : m_keyHead) X = None;
+	for (uint16_t& X : m_buttonHead) X = None;
+}
+
+LIBANOP_FUNC_CODEPT uint16_t c_ActionMap::addAction(const std::string& name) {
+	check_bounds( m_names.size() < None );
+	for (const std::string& X : m_names) {
+		check_param( X != name );
+	}
+	m_names.push_back(name);
+	m_states.push_back(0);
+	m_activeCount.push_back(0);
+	return uint16_t(m_names.size() - 1);
+}
+LIBANOP_FUNC_CODEPT uint16_t c_ActionMap::findAction(const std::string& name) const {
+	for (size_t i = 0; i < m_names.size(); i++) {
+		if (m_names[i] == name) return uint16_t(i);
+	}
+	check_param( !"No action with this name" );
+	return None;
+}
+LIBANOP_FUNC_CODEPT const std::string& c_ActionMap::getActionName(uint16_t action) const {
+	check_bounds( action < m_names.size() );
+	return m_names[action];
+}
+
+//! 'code' must be in range; bindings are checked when made, and feed() skips anything else.
+LIBANOP_FUNC_CODEPT uint16_t& c_ActionMap::headOf(e_Input_Source source, uint16_t code) {
+	return (source == SOURCE_KEY) ? m_keyHead[code] : m_buttonHead[code];
+}
+
+LIBANOP_FUNC_CODEPT void c_ActionMap::bind(uint16_t action, const c_InputBinding& binding) {
+	check_bounds( action < m_names.size() );
+	uint16_t Index = m_freeSlot;
+	if (Index != None) {
+		m_freeSlot = m_slots[Index].Next;
+	} else {
+		check_bounds( m_slots.size() < None );
+		Index = uint16_t(m_slots.size());
+		m_slots.emplace_back();
+	}
+	c_Slot& New = m_slots[Index];
+	New.Binding = binding;
+	New.Action = action;
+	New.Active = 0;
+	New.ChordSize = 0;
+	for (SDL_Scancode X : binding.Chord) {
+		if (X != SDL_SCANCODE_UNKNOWN) New.ChordSize++;
+	}
+	// Keep each chain sorted by chord size, largest first, so the most specific chord is always found first.
+	uint16_t* Link = &(this->headOf(binding.Source, binding.Code));
+	while (*Link != None && m_slots[*Link].ChordSize >= New.ChordSize) Link = &(m_slots[*Link].Next);
+	New.Next = *Link;
+	*Link = Index;
+}
+
+LIBANOP_FUNC_CODEPT bool c_ActionMap::unbind(uint16_t action, const c_InputBinding& binding) {
+	check_bounds( action < m_names.size() );
+	uint16_t* Link = &(this->headOf(binding.Source, binding.Code));
+	while (*Link != None) {
+		c_Slot& X = m_slots[*Link];
+		if (X.Action == action && X.Binding == binding) {
+			if (X.Active) this->deactivate(X);
+			const uint16_t Freed = *Link;
+			*Link = X.Next;
+			X.Next = m_freeSlot;
+			m_freeSlot = Freed;
+			return true;
+		}
+		Link = &(X.Next);
+	}
+	return false;
+}
+
+LIBANOP_FUNC_CODEPT void c_ActionMap::unbindAll(uint16_t action) {
+	check_bounds( action < m_names.size() );
+	std::vector<c_InputBinding> Bound;
+	for (uint16_t Head : m_keyHead) {
+		for (uint16_t i = Head; i != None; i = m_slots[i].Next) if (m_slots[i].Action == action) Bound.push_back(m_slots[i].Binding);
+	}
+	for (uint16_t Head : m_buttonHead) {
+		for (uint16_t i = Head; i != None; i = m_slots[i].Next) if (m_slots[i].Action == action) Bound.push_back(m_slots[i].Binding);
+	}
+	for (const c_InputBinding& X : Bound) this->unbind(action, X);
+}
+
+LIBANOP_FUNC_CODEPT void c_ActionMap::rebind(uint16_t action, const c_InputBinding& binding) {
+	this->unbindAll(action);
+	this->bind(action, binding);
+}
+
+LIBANOP_FUNC_CODEPT void c_ActionMap::activate(c_Slot& slot) {
+	slot.Active = 1;
+	if (m_activeCount[slot.Action]++ == 0) m_states[slot.Action] |= ACTION_HELD | ACTION_PRESSED;
+}
+LIBANOP_FUNC_CODEPT void c_ActionMap::deactivate(c_Slot& slot) {
+	slot.Active = 0;
+	if (--m_activeCount[slot.Action] == 0) {
+		m_states[slot.Action] &= ~ACTION_HELD;
+		m_states[slot.Action] |= ACTION_RELEASED;
+	}
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void c_ActionMap::inputDown(e_Input_Source source, uint16_t code) {
+	// Chains are sorted largest chord first, so the first match sets which chord size fires.
+	int16_t Firing = -1;
+	for (uint16_t i = this->headOf(source, code); i != None; i = m_slots[i].Next) {
+		c_Slot& X = m_slots[i];
+		if (X.ChordSize < Firing) break;
+		if (X.Active) continue;
+		bool Match = 1;
+		for (uint8_t c = 0; c < X.ChordSize; c++) Match = Match && m_keysHeld.test(X.Binding.Chord[c]);
+		if (!Match) continue;
+		Firing = X.ChordSize;
+		this->activate(X);
+	}
+}
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void c_ActionMap::inputUp(e_Input_Source source, uint16_t code) {
+	for (uint16_t i = this->headOf(source, code); i != None; i = m_slots[i].Next) {
+		if (m_slots[i].Active) this->deactivate(m_slots[i]);
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_ActionMap::beginFrame() noexcept {
+	for (uint8_t& X : m_states) X &= ACTION_HELD;
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void c_ActionMap::feed(const SDL_Event* events, size_t count) {
+	check_ptr( events != NULL || count == 0 );
+	for (size_t i = 0; i < count; i++) {
+		const SDL_Event& E = events[i];
+		switch (E.type) {
+			case SDL_KEYDOWN:
+				if (E.key.repeat) break;
+				this->inputDown(SOURCE_KEY, E.key.keysym.scancode);
+				m_keysHeld.set(E.key.keysym.scancode);
+				break;
+			case SDL_KEYUP:
+				m_keysHeld.reset(E.key.keysym.scancode);
+				this->inputUp(SOURCE_KEY, E.key.keysym.scancode);
+				break;
+			// Extra buttons past what can be bound are skipped, rather than wrapped onto real ones.
+			case SDL_MOUSEBUTTONDOWN:
+				if (E.button.button < MouseButtons) this->inputDown(SOURCE_MOUSE_BUTTON, E.button.button);
+				break;
+			case SDL_MOUSEBUTTONUP:
+				if (E.button.button < MouseButtons) this->inputUp(SOURCE_MOUSE_BUTTON, E.button.button);
+				break;
+			default:
+				break;
+		};
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_ActionMap::releaseAll() noexcept {
+	for (c_Slot& X : m_slots) {
+		if (X.Active) this->deactivate(X);
+	}
+	m_keysHeld.clear();
+}
+
+}} // End Anoptamin::Base
@@ -30,9 +30,176 @@
 
 #include "../include/sdl.hpp"
 
+#if !LIBANOP_WINDOWS
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
 namespace Anoptamin { namespace Base {
 
+//! Number of route keys for each e_SDLRoute_Kind.
+static const uint32_t anoptamin_routekeys[4] = {3 * SDL_NUM_SCANCODES, 18, 256, 4};
+
+//! Reduces an event to its route key.
+static inline uint32_t RouteKey(e_SDLRoute_Kind kind, const SDL_Event& event) {
+	switch (kind) {
+		case ROUTE_KEYBOARD: {
+			const uint32_t Sub = (event.type == SDL_KEYUP) ? 1 : (event.key.repeat ? 2 : 0);
+			return Sub * SDL_NUM_SCANCODES + (uint32_t(event.key.keysym.scancode) % SDL_NUM_SCANCODES);
+		}
+		case ROUTE_MOUSE_BUTTON:
+			// Buttons past what SDL_BUTTON() masks can name get keys of their own (16 and 17), instead of landing on real ones.
+			if (event.button.button >= 8) return 16 + ((event.type == SDL_MOUSEBUTTONUP) ? 1 : 0);
+			return ((event.type == SDL_MOUSEBUTTONUP) ? 8 : 0) + event.button.button;
+		case ROUTE_MOUSE_MOTION:
+			return event.motion.state & 0xFF;
+		default:
+			return (event.wheel.y != 0 ? 1 : 0) | (event.wheel.x != 0 ? 2 : 0);
+	}
+}
+
+//! Decides whether a filter matches every event with the given route key.
+static bool RouteWants(e_SDLRoute_Kind kind, const c_SDLEventFilter& filter, uint32_t key) {
+	switch (kind) {
+		case ROUTE_KEYBOARD: {
+			const uint8_t Sub = uint8_t(1) << (key / SDL_NUM_SCANCODES);
+			return (filter.Subtypes == 0 || (filter.Subtypes & Sub)) && (filter.Scancodes.none() || filter.Scancodes.test(key % SDL_NUM_SCANCODES));
+		}
+		case ROUTE_MOUSE_BUTTON: {
+			if (key >= 16) {
+				// Only filters which don't name any button want them.
+				const uint8_t Sub = (key == 17) ? SUBTYPE_RELEASE : SUBTYPE_PRESS;
+				return (filter.Subtypes == 0 || (filter.Subtypes & Sub)) && filter.MouseButtons == 0;
+			}
+			const uint8_t Sub = (key >= 8) ? SUBTYPE_RELEASE : SUBTYPE_PRESS, Button = key & 7;
+			return (filter.Subtypes == 0 || (filter.Subtypes & Sub)) && (filter.MouseButtons == 0 || (Button != 0 && (filter.MouseButtons & SDL_BUTTON(Button))));
+		}
+		case ROUTE_MOUSE_MOTION:
+			return (filter.MouseButtons == 0 || (filter.MouseButtons & key));
+		default:
+			return (filter.Subtypes == 0 || ((key & 1) && (filter.Subtypes & SUBTYPE_SCROLL_VERTICAL)) || ((key & 2) && (filter.Subtypes & SUBTYPE_SCROLL_HORIZONTAL)));
+	}
+}
+
+LIBANOP_FUNC_CODEPT c_SDLEventRouter::c_SDLEventRouter(e_SDLRoute_Kind kind) {
+	m_kind = kind;
+	m_offsets.assign(anoptamin_routekeys[kind] + 1, 0);
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLEventRouter::compile() {
+	const uint32_t Keys = anoptamin_routekeys[m_kind];
+	m_targets.clear();
+	for (uint32_t Key = 0; Key < Keys; Key++) {
+		m_offsets[Key] = uint32_t(m_targets.size());
+		for (size_t i = 0; i < m_routes.size(); i++) {
+			if (RouteWants(m_kind, m_routes[i].Filter, Key)) m_targets.push_back(uint16_t(i));
+		}
+	}
+	m_offsets[Keys] = uint32_t(m_targets.size());
+}
+
+LIBANOP_FUNC_CODEPT uint16_t c_SDLEventRouter::add(const c_Hookable_Func& function, const c_SDLEventFilter& filter, const std::string& name) {
+	check_bounds( m_routes.size() < UINT16_MAX );
+	c_Route New;
+	New.Hook.reset(new c_Function_Hook(name.c_str(), true));
+	New.Hook->HookFunction(function);
+	New.Filter = filter;
+	m_routes.push_back(std::move(New));
+	this->compile();
+	return uint16_t(m_routes.size());
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT void c_SDLEventRouter::route(const SDL_Event& event) {
+	const uint32_t Key = RouteKey(m_kind, event);
+	for (uint32_t i = m_offsets[Key]; i < m_offsets[Key + 1]; i++) {
+		std::vector<SDL_Event>& Batch = m_routes[m_targets[i]].Batch;
+		if (Batch.empty()) m_pending.push_back(m_targets[i]);
+		Batch.push_back(event);
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLEventRouter::dispatch() {
+	for (uint16_t i : m_pending) {
+		c_Route& X = m_routes[i];
+		X.Hook->InvokeDiscard<SDL_Event>(X.Batch.data(), X.Batch.size());
+		X.Batch.clear();
+	}
+	m_pending.clear();
+}
+
+//! A window's render thread and the back buffers it hands over; see c_SDLWindow::startRenderThread.
+//! 'Handoff' holds the buffer between the two threads, with the Fresh bit set while it holds a frame not yet shown.
+//! The thread draws into a buffer only it holds, and swaps it in with a single exchange. With three buffers the main
+//! thread holds the third, and swaps it for a fresh frame the same way; with two it copies the fresh frame straight
+//! out of the shared buffer, and clears the Fresh bit to hand it back.
+struct c_RenderThread {
+	static constexpr uint8_t Fresh = 0x80, Mask = 0x03;
+	
+	t_RenderThreadFunc Render;
+	uint8_t Buffers;
+	std::vector<uint32_t> Pixels[3];
+	Graphics::c_PixelView Views[3];
+	uint64_t FinishedAt[3] = {}; // When each buffer's frame was finished, on clockNanos().
+	std::atomic<uint8_t> Handoff{1};
+	uint8_t Front = 2; // The main thread's buffer, with three.
+	std::atomic<uint32_t> Size; // Window size, width in the top 16 bits, which the thread sizes its buffers to.
+	std::atomic<bool> Running{1};
+	std::atomic<uint64_t> Rendered{0}, Presented{0}, Dropped{0}, Stale{0}, LastRender{0};
+	c_LatencyHistogram RenderTime, FrameAge;
+	std::thread Thread;
+	
+	//! Sizes a buffer to the window, if it is not already.
+	void fit(uint8_t buffer) {
+		const uint32_t Packed = this->Size.load(std::memory_order_relaxed);
+		const int32_t Width = int32_t(Packed >> 16), Height = int32_t(Packed & 0xFFFF);
+		Graphics::c_PixelView& View = this->Views[buffer];
+		if (View.Width == Width && View.Height == Height) return;
+		this->Pixels[buffer].assign(size_t(Width) * size_t(Height), 0);
+		View = {this->Pixels[buffer].data(), Width, Height, Width};
+	}
+	
+	//! The thread itself: draws a frame into its buffer, waits for the last one to be shown if double buffered, and
+	//! hands the frame over.
+	void loop() {
+		uint8_t Back = 0;
+		while (this->Running.load(std::memory_order_acquire)) {
+			this->fit(Back);
+			const uint64_t Start = clockNanos();
+			try {
+				this->Render(this->Views[Back], this->Rendered.load(std::memory_order_relaxed));
+			} catch (const std::exception& e) {
+				Anoptamin_LogError(std::string("Render thread stopped by an exception: ") + e.what());
+				this->Running.store(0, std::memory_order_release);
+				return;
+			}
+			const uint64_t End = clockNanos();
+			this->RenderTime.record(End - Start);
+			this->LastRender.store(End - Start, std::memory_order_relaxed);
+			this->FinishedAt[Back] = End;
+			
+			if (this->Buffers == 2) {
+				while (this->Handoff.load(std::memory_order_acquire) & Fresh) {
+					if (!this->Running.load(std::memory_order_acquire)) return;
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			}
+			const uint8_t Old = this->Handoff.exchange(Back | Fresh, std::memory_order_acq_rel);
+			if (Old & Fresh) this->Dropped.fetch_add(1, std::memory_order_relaxed);
+			Back = Old & Mask;
+			this->Rendered.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	
+	~c_RenderThread() {
+		this->Running.store(0, std::memory_order_release);
+		if (this->Thread.joinable()) this->Thread.join();
+	}
+};
+
 LIBANOP_FUNC_CODEPT void c_SDLWindow::cleanup() {
+	this->stopRenderThread();
 	Anoptamin_LogDebug("Cleaning up window ID #" + std::to_string( SDL_GetWindowID(this->mp_window) ));
 	SDL_UpdateWindowSurface( this->mp_window );
 	
@@ -98,8 +265,13 @@ LIBANOP_FUNC_CODEPT c_SDLWindow::c_SDLWindow(uint16_t width, uint16_t height, st
 	m_hookMouseScrl.CatchHookedErrors = 1;
 	m_hookMouseMove.Name = ("Mouse Movement Hook for Window #" + windowID);
 	m_hookMouseMove.CatchHookedErrors = 1;
+	m_hookMouseMoveRaw.Name = ("Raw Mouse Movement Hook for Window #" + windowID);
+	m_hookMouseMoveRaw.CatchHookedErrors = 1;
 	
+	m_windowID = SDL_GetWindowID(mp_window);
+	m_dirty.setBounds(mp_baseSurf->w, mp_baseSurf->h);
 	m_open = 1;
+	c_EventDispatcher::get().addWindow(this);
 }
 
 LIBANOP_FUNC_CODEPT c_SDLWindow::c_SDLWindow(uint16_t width, uint16_t height, std::string title, int32_t posx, int32_t posy, bool centerOnOpen,
@@ -157,14 +329,20 @@ LIBANOP_FUNC_CODEPT c_SDLWindow::c_SDLWindow(uint16_t width, uint16_t height, st
 	m_hookMouseScrl.CatchHookedErrors = 1;
 	m_hookMouseMove.Name = ("Mouse Movement Hook for Window #" + windowID);
 	m_hookMouseMove.CatchHookedErrors = 1;
+	m_hookMouseMoveRaw.Name = ("Raw Mouse Movement Hook for Window #" + windowID);
+	m_hookMouseMoveRaw.CatchHookedErrors = 1;
 	
 	SDL_SetWindowPosition(mp_window, posx, posy);
 	
+	m_windowID = SDL_GetWindowID(mp_window);
+	m_dirty.setBounds(mp_baseSurf->w, mp_baseSurf->h);
 	m_open = 1;
+	c_EventDispatcher::get().addWindow(this);
 }
 
 LIBANOP_FUNC_CODEPT c_SDLWindow::~c_SDLWindow() {
 	
+	c_EventDispatcher::get().removeWindow(this);
 	if (this->m_open) {
 		this->cleanup();
 		this->mp_window = NULL;  // the SDL_FreeSurface and sort performs the freeing of these
@@ -184,20 +362,37 @@ LIBANOP_FUNC_CODEPT void c_SDLWindow::closeWindow() {
 }
 
 
-LIBANOP_FUNC_CODEPT std::vector<SDL_Event> c_SDLWindow::fullEventPoll() {
-	
-	std::vector<SDL_Event> Out, KeyEvents, MouseBtnEvents, MouseScrlEvents, MouseMoveEvents;
-	int32_t X;
-	if (this->m_open) {
-		do {
-			X = SDL_PollEvent( &(this->m_windowEvents) );
-			switch (this->m_windowEvents.type) {
-				case SDL_QUIT:
-					this->closeWindow();
-					break;
+LIBANOP_FUNC_CODEPT void c_KeySet::load(const uint8_t* states, int32_t count) noexcept {
+	this->clear();
+	if (count > Bits) count = Bits;
+	int32_t i = 0;
+#if defined(__SSE2__)
+	// Sixteen keys at a time: compare the bytes against zero, and gather the results into a 16-bit mask.
+	const __m128i Zero = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16) {
+		const __m128i States = _mm_loadu_si128((const __m128i*)(states + i));
+		const uint64_t Held = uint16_t(~_mm_movemask_epi8(_mm_cmpeq_epi8(States, Zero)));
+		this->Words[i >> 6] |= Held << (i & 63);
+	}
+#endif
+	for (; i < count; i++) {
+		if (states[i]) this->Words[i >> 6] |= uint64_t(1) << (i & 63);
+	}
+}
+
+//! Number of events taken from SDL per SDL_PeepEvents call.
+static constexpr int anoptamin_peepblock = 128;
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::handleEvent(SDL_Event& event) {
+	switch (event.type) {
+		case SDL_QUIT:
+			this->closeWindow();
+			break;
+		case SDL_WINDOWEVENT:
+			switch (event.window.event) {
 				case SDL_WINDOWEVENT_CLOSE:
 					this->closeWindow();
-					this->m_windowEvents.type = SDL_QUIT;
+					event.type = SDL_QUIT;
 					break;
 				case SDL_WINDOWEVENT_SHOWN:
 					this->m_hidden = 0;
@@ -206,51 +401,641 @@ LIBANOP_FUNC_CODEPT std::vector<SDL_Event> c_SDLWindow::fullEventPoll() {
 					this->m_hidden = 1;
 					break;
 				case SDL_WINDOWEVENT_RESIZED:
-					this->checkDimensions();
-					break;
 				case SDL_WINDOWEVENT_SIZE_CHANGED:
 					this->checkDimensions();
+					// SDL replaces the window surface on a resize.
+					this->mp_baseSurf = SDL_GetWindowSurface( this->mp_window );
+					assert_libsdl( this->mp_baseSurf != NULL );
+					this->m_dirty.setBounds(this->mp_baseSurf->w, this->mp_baseSurf->h);
+					this->fitBackbuffer();
 					break;
-				case SDL_MOUSEMOTION:
-					MouseMoveEvents.push_back(this->m_windowEvents);
-					break;
-				case SDL_MOUSEWHEEL:
-					MouseScrlEvents.push_back(this->m_windowEvents);
-					break;
-				case SDL_MOUSEBUTTONUP:
-					MouseBtnEvents.push_back(this->m_windowEvents);
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					MouseBtnEvents.push_back(this->m_windowEvents);
-					break;
-				case SDL_KEYDOWN:
-					KeyEvents.push_back(this->m_windowEvents);
-					break;
-				case SDL_KEYUP:
-					KeyEvents.push_back(this->m_windowEvents);
+				case SDL_WINDOWEVENT_EXPOSED:
+					this->m_dirty.addAll();
 					break;
 				default:
 					break;
 			};
-			Out.push_back(this->m_windowEvents);
-		} while (X != 0);
+			break;
+		case SDL_MOUSEMOTION:
+			this->m_polledMouseMove.push_back(event);
+			break;
+		case SDL_MOUSEWHEEL:
+			this->m_polledMouseScrl.push_back(event);
+			break;
+		case SDL_MOUSEBUTTONUP:
+		case SDL_MOUSEBUTTONDOWN:
+			this->m_polledMouseBtn.push_back(event);
+			break;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			this->m_polledKeys.push_back(event);
+			break;
+		default:
+			break;
+	};
+}
+
+//! Merges each run of motion events from the same mouse and window into one: summed relative motion, the final position
+//! and timestamp, and every button held during the run.
+static void CoalesceMotion(const std::vector<SDL_Event>& in, std::vector<SDL_Event>& out) {
+	out.clear();
+	for (const SDL_Event& E : in) {
+		if (!out.empty()) {
+			SDL_MouseMotionEvent& Last = out.back().motion;
+			if (Last.which == E.motion.which && Last.windowID == E.motion.windowID) {
+				const int32_t RelX = Last.xrel + E.motion.xrel, RelY = Last.yrel + E.motion.yrel;
+				const uint32_t State = Last.state | E.motion.state;
+				Last = E.motion;
+				Last.xrel = RelX;
+				Last.yrel = RelY;
+				Last.state = State;
+				continue;
+			}
+		}
+		out.push_back(E);
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::dispatchHooks() {
+	// Anything other threads raised since the last poll joins the same batch.
+	this->m_hookMouseMove.TakeDeferred<SDL_Event>(this->m_polledMouseMove);
+	this->m_hookMouseScrl.TakeDeferred<SDL_Event>(this->m_polledMouseScrl);
+	this->m_hookMouseBtn.TakeDeferred<SDL_Event>(this->m_polledMouseBtn);
+	this->m_hookKeyboard.TakeDeferred<SDL_Event>(this->m_polledKeys);
+	
+	if (this->m_polledMouseMove.size() != 0) {
+		this->m_hookMouseMoveRaw.InvokeDiscard<SDL_Event>(this->m_polledMouseMove.data(), this->m_polledMouseMove.size());
+	}
+	const std::vector<SDL_Event>* Motion = &(this->m_polledMouseMove);
+	if (this->m_coalesceMotion) {
+		CoalesceMotion(this->m_polledMouseMove, this->m_coalescedMouseMove);
+		Motion = &(this->m_coalescedMouseMove);
+	}
+	
+	if (!this->m_routeMouseMove.empty()) {
+		for (const SDL_Event& E : *Motion) this->m_routeMouseMove.route(E);
+		this->m_routeMouseMove.dispatch();
+	}
+	if (!this->m_routeMouseScrl.empty()) {
+		for (const SDL_Event& E : this->m_polledMouseScrl) this->m_routeMouseScrl.route(E);
+		this->m_routeMouseScrl.dispatch();
+	}
+	if (!this->m_routeMouseBtn.empty()) {
+		for (const SDL_Event& E : this->m_polledMouseBtn) this->m_routeMouseBtn.route(E);
+		this->m_routeMouseBtn.dispatch();
+	}
+	if (!this->m_routeKeyboard.empty()) {
+		for (const SDL_Event& E : this->m_polledKeys) this->m_routeKeyboard.route(E);
+		this->m_routeKeyboard.dispatch();
 	}
 	
-	if (MouseMoveEvents.size() != 0) {
-		this->m_hookMouseMove.Invoke<SDL_Event>(MouseMoveEvents);
+	if (Motion->size() != 0) {
+		this->m_hookMouseMove.InvokeDiscard<SDL_Event>(Motion->data(), Motion->size());
+	}
+	if (this->m_polledMouseScrl.size() != 0) {
+		this->m_hookMouseScrl.InvokeDiscard<SDL_Event>(this->m_polledMouseScrl.data(), this->m_polledMouseScrl.size());
 	}
-	if (MouseScrlEvents.size() != 0) {
-		this->m_hookMouseScrl.Invoke<SDL_Event>(MouseScrlEvents);
+	if (this->m_polledMouseBtn.size() != 0) {
+		this->m_hookMouseBtn.InvokeDiscard<SDL_Event>(this->m_polledMouseBtn.data(), this->m_polledMouseBtn.size());
+	}
+	if (this->m_polledKeys.size() != 0) {
+		this->m_hookKeyboard.InvokeDiscard<SDL_Event>(this->m_polledKeys.data(), this->m_polledKeys.size());
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::beginPoll() {
+	this->m_polledAll.clear();
+	this->m_polledKeys.clear();
+	this->m_polledMouseBtn.clear();
+	this->m_polledMouseMove.clear();
+	this->m_polledMouseScrl.clear();
+	if (!this->m_open) return;
+	
+	int32_t KeyCount = 0;
+	const uint8_t* Keystates = SDL_GetKeyboardState( &KeyCount );
+	assert_libsdl( Keystates != NULL );
+	this->m_keysBefore = this->m_keysNow;
+	this->m_keysNow.load(Keystates, KeyCount);
+	c_KeySet::edges(this->m_keysNow, this->m_keysBefore, this->m_keysPressed, this->m_keysReleased);
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::acceptEvent(const SDL_Event& event) {
+	this->m_polledAll.push_back(event);
+	this->handleEvent(this->m_polledAll.back());
+}
+
+//! Follows input events from SDL's queue to the screen for a window; see c_SDLWindow::setInputTracing.
+struct c_InputTracer {
+	struct c_Traced {
+		uint64_t Queued; // When SDL queued it, on clockNanos().
+		e_SDLTrace_Category Category;
+	};
+	static constexpr size_t MaxWaiting = 65536; // Bounds the backlog if nothing ever presents.
+	
+	std::vector<c_Traced> Polling; // Events of the poll in progress.
+	std::vector<c_Traced> Waiting; // Events through the hooks, waiting for a present.
+	c_LatencyHistogram Polled[TRACE_COUNT], Dispatched[TRACE_COUNT], Presented[TRACE_COUNT];
+};
+
+static const char* const anoptamin_tracenames[TRACE_COUNT] = {"keyboard", "mouse button", "mouse motion", "mouse scroll"};
+
+//! Starts tracing one category of a poll's events. SDL's timestamps are whole milliseconds of SDL_GetTicks, so each is
+//! placed in the middle of its millisecond, relative to the current time on both clocks.
+static void TracePolled(c_InputTracer& tracer, const std::vector<SDL_Event>& events, e_SDLTrace_Category category,
+	uint64_t nowNanos, uint32_t nowTicks) {
+	for (const SDL_Event& E : events) {
+		const uint32_t Ticks = E.common.timestamp;
+		if (Ticks == 0 || Ticks > nowTicks) continue;
+		const uint64_t Age = uint64_t(nowTicks - Ticks) * 1000000 + 500000;
+		tracer.Polled[category].record(Age);
+		tracer.Polling.push_back({nowNanos - Age, category});
 	}
-	if (MouseBtnEvents.size() != 0) {
-		this->m_hookMouseBtn.Invoke<SDL_Event>(MouseBtnEvents);
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::endPoll() {
+	if (this->m_recording && !this->m_polledAll.empty()) this->recordPoll();
+	if (this->mp_tracer) {
+		const uint64_t Now = clockNanos();
+		const uint32_t Ticks = SDL_GetTicks();
+		TracePolled(*this->mp_tracer, this->m_polledKeys, TRACE_KEYBOARD, Now, Ticks);
+		TracePolled(*this->mp_tracer, this->m_polledMouseBtn, TRACE_MOUSE_BUTTON, Now, Ticks);
+		TracePolled(*this->mp_tracer, this->m_polledMouseMove, TRACE_MOUSE_MOTION, Now, Ticks);
+		TracePolled(*this->mp_tracer, this->m_polledMouseScrl, TRACE_MOUSE_SCROLL, Now, Ticks);
 	}
-	if (KeyEvents.size() != 0) {
-		this->m_hookKeyboard.Invoke<SDL_Event>(KeyEvents);
+	const uint64_t Start = clockTicks();
+	this->dispatchHooks();
+	const uint64_t End = clockTicks();
+	this->m_lastHookNanos = clockTicksToNanos(End - Start);
+	
+	if (this->mp_tracer && !this->mp_tracer->Polling.empty()) {
+		c_InputTracer& T = *this->mp_tracer;
+		const uint64_t Now = clockTicksToNanos(End);
+		for (const c_InputTracer::c_Traced& X : T.Polling) T.Dispatched[X.Category].record(Now - X.Queued);
+		if (T.Waiting.size() + T.Polling.size() <= c_InputTracer::MaxWaiting) T.Waiting.insert(T.Waiting.end(), T.Polling.begin(), T.Polling.end());
+		T.Polling.clear();
 	}
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::markPresented() {
+	if (!this->mp_tracer || this->mp_tracer->Waiting.empty()) return;
+	c_InputTracer& T = *this->mp_tracer;
+	const uint64_t Now = clockNanos();
+	for (const c_InputTracer::c_Traced& X : T.Waiting) T.Presented[X.Category].record(Now - X.Queued);
+	T.Waiting.clear();
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::setInputTracing(bool enabled) {
+	if (!enabled) this->mp_tracer.reset();
+	else if (!this->mp_tracer) this->mp_tracer.reset(new c_InputTracer());
+}
+
+LIBANOP_FUNC_CODEPT bool c_SDLWindow::getInputTracing() const noexcept {
+	return (this->mp_tracer != nullptr);
+}
+
+LIBANOP_FUNC_CODEPT c_SDLInputLatency c_SDLWindow::getInputLatency(e_SDLTrace_Category category) const {
+	check_bounds( category < TRACE_COUNT );
+	c_SDLInputLatency Out;
+	if (!this->mp_tracer) return Out;
+	Out.Polled = this->mp_tracer->Polled[category].getSummary();
+	Out.Dispatched = this->mp_tracer->Dispatched[category].getSummary();
+	Out.Presented = this->mp_tracer->Presented[category].getSummary();
 	return Out;
 }
 
+LIBANOP_FUNC_CODEPT void c_SDLWindow::resetInputLatency() {
+	if (this->mp_tracer) this->mp_tracer.reset(new c_InputTracer());
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_COLD void c_SDLWindow::logInputLatencyReport() const {
+	if (!this->mp_tracer) return;
+	Anoptamin_LogInfo("Input latency report for window '" + this->m_windowTitle + "' (ns, p50/p99/max):");
+	for (uint8_t i = 0; i < TRACE_COUNT; i++) {
+		const c_SDLInputLatency L = this->getInputLatency(e_SDLTrace_Category(i));
+		if (L.Polled.Count == 0) continue;
+		Anoptamin_LogInfoF("  {}: {} events; polled {}/{}/{}, dispatched {}/{}/{}, presented {}/{}/{} ({} presented)",
+			anoptamin_tracenames[i], L.Polled.Count, L.Polled.P50, L.Polled.P99, L.Polled.Max,
+			L.Dispatched.P50, L.Dispatched.P99, L.Dispatched.Max, L.Presented.P50, L.Presented.P99, L.Presented.Max, L.Presented.Count);
+	}
+}
+
+//! Drains SDL's whole queue onto the end of 'out', a block at a time. Returns the index of the first new event.
+static size_t DrainQueue(std::vector<SDL_Event>& out) {
+	const size_t First = out.size();
+	int32_t Got;
+	do {
+		const size_t Had = out.size();
+		out.resize(Had + anoptamin_peepblock);
+		Got = SDL_PeepEvents(out.data() + Had, anoptamin_peepblock, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+		assert_libsdl( Got >= 0 );
+		out.resize(Had + Got);
+	} while (Got == anoptamin_peepblock);
+	return First;
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT c_SDLEventView c_SDLWindow::pollEvents() {
+	if (this->m_open) SDL_PumpEvents();
+	this->beginPoll();
+	if (this->m_open) {
+		for (size_t i = DrainQueue(this->m_polledAll); i < this->m_polledAll.size(); i++) this->handleEvent(this->m_polledAll[i]);
+	}
+	this->endPoll();
+	
+	c_SDLEventView Out;
+	Out.Events = this->m_polledAll.data();
+	Out.Count = this->m_polledAll.size();
+	return Out;
+}
+
+LIBANOP_FUNC_CODEPT c_SDLEventView c_SDLWindow::waitEvents() {
+	if (!this->m_open) return this->pollEvents();
+	
+	const uint32_t Flags = SDL_GetWindowFlags(this->mp_window);
+	const bool Idle = (Flags & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) || !(Flags & SDL_WINDOW_INPUT_FOCUS);
+	const uint64_t Frame = uint64_t(this->m_waitFrameMillis) * 1000000;
+	uint64_t Now = clockNanos();
+	
+	int32_t Timeout = 0;
+	if (Idle) {
+		Timeout = int32_t(this->m_waitIdleMillis);
+	} else if (this->m_waitDeadline > Now) {
+		Timeout = int32_t((this->m_waitDeadline - Now) / 1000000); // Rounded down; SDL's timeouts may run over by a millisecond.
+	}
+	bool FrameDue = (Timeout == 0);
+	if (Timeout > 0) {
+		const int32_t Woken = SDL_WaitEventTimeout(NULL, Timeout);
+		const uint64_t Blocked = clockNanos() - Now;
+		Now += Blocked;
+		this->m_waitStats.Waits++;
+		this->m_waitStats.BlockedNanos += Blocked;
+		if (Idle) this->m_waitStats.IdleWaits++;
+		if (Woken) {
+			this->m_waitStats.EventWakeups++;
+		} else {
+			FrameDue = 1;
+			this->m_waitStats.TimeoutWakeups++;
+			const uint64_t Asked = uint64_t(Timeout) * 1000000;
+			this->m_waitOversleep.record(Blocked > Asked ? Blocked - Asked : 0);
+		}
+	}
+	// Frames stay on a fixed grid while active; waking early for an event does not move the next deadline, and one which
+	// has fallen behind (or is coming back from idle) restarts the grid from now instead of rushing to catch up.
+	if (FrameDue) {
+		this->m_waitDeadline += Frame;
+		if (Idle || this->m_waitDeadline <= Now) this->m_waitDeadline = Now + Frame;
+	}
+	
+	const c_SDLEventView Polled = this->pollEvents();
+	const uint32_t Ticks = SDL_GetTicks();
+	for (const SDL_Event& E : Polled) {
+		if (E.common.timestamp != 0 && E.common.timestamp <= Ticks) this->m_waitEventLatency.record(uint64_t(Ticks - E.common.timestamp) * 1000000);
+	}
+	return Polled;
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::setWaitTiming(uint16_t frameMillis, uint32_t idleMillis) {
+	check_param( frameMillis != 0 && idleMillis != 0 );
+	this->m_waitFrameMillis = frameMillis;
+	this->m_waitIdleMillis = idleMillis;
+}
+
+LIBANOP_FUNC_CODEPT c_SDLWaitStats c_SDLWindow::getWaitStats() const {
+	c_SDLWaitStats Out = this->m_waitStats;
+	Out.EventLatency = this->m_waitEventLatency.getSummary();
+	Out.Oversleep = this->m_waitOversleep.getSummary();
+	return Out;
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::resetWaitStats() {
+	this->m_waitStats = c_SDLWaitStats();
+	this->m_waitEventLatency.reset();
+	this->m_waitOversleep.reset();
+}
+
+//! Gets the window an event belongs to, or zero if it belongs to none.
+static inline uint32_t EventWindowID(const SDL_Event& event) {
+	switch (event.type) {
+		case SDL_WINDOWEVENT: return event.window.windowID;
+		case SDL_KEYDOWN: case SDL_KEYUP: return event.key.windowID;
+		case SDL_TEXTEDITING: return event.edit.windowID;
+		case SDL_TEXTINPUT: return event.text.windowID;
+		case SDL_MOUSEMOTION: return event.motion.windowID;
+		case SDL_MOUSEBUTTONDOWN: case SDL_MOUSEBUTTONUP: return event.button.windowID;
+		case SDL_MOUSEWHEEL: return event.wheel.windowID;
+		default: return (event.type >= SDL_USEREVENT && event.type < SDL_LASTEVENT) ? event.user.windowID : 0;
+	}
+}
+
+LIBANOP_FUNC_CODEPT c_EventDispatcher::c_EventDispatcher() : m_hookGlobal("Global Event Hook", true) {
+	this->rebuild();
+}
+
+LIBANOP_FUNC_CODEPT c_EventDispatcher& c_EventDispatcher::get() {
+	static c_EventDispatcher Dispatcher;
+	return Dispatcher;
+}
+
+LIBANOP_FUNC_CODEPT void c_EventDispatcher::rebuild() {
+	size_t Size = 8;
+	uint8_t Shift = 29;
+	while (Size < this->m_windows.size() * 2) {
+		Size *= 2;
+		Shift--;
+	}
+	this->m_table.assign(Size, c_Slot());
+	this->m_tableMask = uint32_t(Size - 1);
+	this->m_tableShift = Shift;
+	for (c_SDLWindow* W : this->m_windows) {
+		uint32_t i = (W->m_windowID * 2654435769u) >> Shift;
+		while (this->m_table[i].WindowID != 0) i = (i + 1) & this->m_tableMask;
+		this->m_table[i].WindowID = W->m_windowID;
+		this->m_table[i].Window = W;
+	}
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT c_SDLWindow* c_EventDispatcher::findWindow(uint32_t windowID) const noexcept {
+	uint32_t i = (windowID * 2654435769u) >> this->m_tableShift;
+	while (true) {
+		const c_Slot& X = this->m_table[i];
+		if (X.WindowID == windowID) return X.Window;
+		if (X.WindowID == 0) return NULL;
+		i = (i + 1) & this->m_tableMask;
+	}
+}
+
+LIBANOP_FUNC_CODEPT void c_EventDispatcher::addWindow(c_SDLWindow* window) {
+	check_ptr( window != NULL && window->m_windowID != 0 );
+	this->m_windows.push_back(window);
+	this->rebuild();
+}
+
+LIBANOP_FUNC_CODEPT void c_EventDispatcher::removeWindow(c_SDLWindow* window) {
+	for (size_t i = 0; i < this->m_windows.size(); i++) {
+		if (this->m_windows[i] != window) continue;
+		this->m_windows.erase(this->m_windows.begin() + i);
+		break;
+	}
+	// A hook may destroy a window in the middle of dispatch().
+	for (c_SDLWindow*& W : this->m_dispatching) {
+		if (W == window) W = NULL;
+	}
+	this->rebuild();
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const size_t c_EventDispatcher::getWindowCount() const noexcept {
+	return this->m_windows.size();
+}
+
+LIBANOP_FUNC_CODEPT uint16_t c_EventDispatcher::addGlobalHook(const c_Hookable_Func& function) {
+	return this->m_hookGlobal.HookFunction(function);
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT c_SDLEventView c_EventDispatcher::dispatch() {
+	SDL_PumpEvents();
+	this->m_dispatching = this->m_windows;
+	for (c_SDLWindow* W : this->m_dispatching) W->beginPoll();
+	
+	this->m_events.clear();
+	this->m_global.clear();
+	DrainQueue(this->m_events);
+	
+	// Events come in runs from the same window, so remember the last lookup.
+	uint32_t LastID = 0;
+	c_SDLWindow* Last = NULL;
+	for (const SDL_Event& E : this->m_events) {
+		if (E.type == SDL_QUIT) {
+			this->m_global.push_back(E);
+			for (c_SDLWindow* W : this->m_dispatching) {
+				if (W != NULL) W->acceptEvent(E);
+			}
+			continue;
+		}
+		const uint32_t ID = EventWindowID(E);
+		if (ID != LastID) {
+			LastID = ID;
+			Last = (ID != 0) ? this->findWindow(ID) : NULL;
+		}
+		if (Last != NULL) Last->acceptEvent(E);
+		else this->m_global.push_back(E);
+	}
+	
+	for (size_t i = 0; i < this->m_dispatching.size(); i++) {
+		if (this->m_dispatching[i] != NULL) this->m_dispatching[i]->endPoll();
+	}
+	this->m_dispatching.clear();
+	if (!this->m_global.empty()) {
+		this->m_hookGlobal.InvokeDiscard<SDL_Event>(this->m_global.data(), this->m_global.size());
+	}
+	
+	c_SDLEventView Out;
+	Out.Events = this->m_events.data();
+	Out.Count = this->m_events.size();
+	return Out;
+}
+
+/*
+	Input recordings ('.ainp') are a header, then one record per poll which saw any events:
+		Header: "ANOPINPT", u16 version (1)
+		Poll:   u64 nanoseconds since recording started, u32 event count,
+		        then per event: u16 length, and that many bytes of the SDL_Event
+	Only the union member in use is stored. Integers are in native byte order.
+*/
+static const char anoptamin_inputmagic[8] = {'A', 'N', 'O', 'P', 'I', 'N', 'P', 'T'};
+static const uint16_t anoptamin_inputversion = 1;
+
+//! Gets how many bytes of an event are worth storing.
+static uint16_t RecordedSize(uint32_t type) {
+	switch (type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			return sizeof(SDL_KeyboardEvent);
+		case SDL_MOUSEMOTION:
+			return sizeof(SDL_MouseMotionEvent);
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			return sizeof(SDL_MouseButtonEvent);
+		case SDL_MOUSEWHEEL:
+			return sizeof(SDL_MouseWheelEvent);
+		case SDL_WINDOWEVENT:
+			return sizeof(SDL_WindowEvent);
+		case SDL_QUIT:
+			return sizeof(SDL_CommonEvent);
+		default:
+			return sizeof(SDL_Event);
+	}
+}
+
+template<typename T> static inline void AppendRaw(std::vector<uint8_t>& out, const T& value) {
+	const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(&value);
+	out.insert(out.end(), Bytes, Bytes + sizeof(T));
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::startInputRecording(const std::string& path) {
+	this->stopInputRecording();
+	this->m_recordFile.open(path, std::ios::binary | std::ios::trunc);
+	assert_fileio( this->m_recordFile.is_open() );
+	this->m_recordFile.write(anoptamin_inputmagic, sizeof(anoptamin_inputmagic));
+	this->m_recordFile.write((const char*)&anoptamin_inputversion, sizeof(anoptamin_inputversion));
+	this->m_recordStart = clockNanos();
+	this->m_recording = 1;
+	Anoptamin_LogInfo("Recording input to '" + path + "'.");
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::stopInputRecording() {
+	if (!this->m_recording) return;
+	this->m_recording = 0;
+	this->m_recordFile.close();
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const bool c_SDLWindow::isRecordingInput() const noexcept {
+	return this->m_recording;
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::recordPoll() {
+	std::vector<uint8_t>& Out = this->m_recordBuffer;
+	Out.clear();
+	AppendRaw<uint64_t>(Out, clockNanos() - this->m_recordStart);
+	AppendRaw<uint32_t>(Out, uint32_t(this->m_polledAll.size()));
+	for (const SDL_Event& E : this->m_polledAll) {
+		const uint16_t Length = RecordedSize(E.type);
+		AppendRaw<uint16_t>(Out, Length);
+		const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(&E);
+		Out.insert(Out.end(), Bytes, Bytes + Length);
+	}
+	this->m_recordFile.write((const char*)Out.data(), Out.size());
+}
+
+LIBANOP_FUNC_CODEPT c_InputReplay::c_InputReplay(const std::string& path, double speed) {
+	check_param( speed >= 0.0 );
+	m_speed = speed;
+#if !LIBANOP_WINDOWS
+	const int Handle = open(path.c_str(), O_RDONLY);
+	assert_fileio( Handle >= 0 );
+	struct stat Info;
+	assert_fileio( fstat(Handle, &Info) == 0 );
+	m_size = size_t(Info.st_size);
+	if (m_size != 0) {
+		void* Mapped = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, Handle, 0);
+		assert_fileio( Mapped != MAP_FAILED );
+		mp_data = static_cast<const uint8_t*>(Mapped);
+		m_mapped = 1;
+	}
+	close(Handle);
+#else
+	std::ifstream In(path, std::ios::binary);
+	assert_fileio( In.is_open() );
+	m_loaded.assign(std::istreambuf_iterator<char>(In), std::istreambuf_iterator<char>());
+	mp_data = m_loaded.data();
+	m_size = m_loaded.size();
+#endif
+	uint16_t Version = 0;
+	check_loaded( m_size >= sizeof(anoptamin_inputmagic) + sizeof(Version) );
+	check_loaded( std::memcmp(mp_data, anoptamin_inputmagic, sizeof(anoptamin_inputmagic)) == 0 );
+	std::memcpy(&Version, mp_data + sizeof(anoptamin_inputmagic), sizeof(Version));
+	check_loaded( Version == anoptamin_inputversion );
+	this->restart();
+}
+
+LIBANOP_FUNC_CODEPT c_InputReplay::~c_InputReplay() {
+#if !LIBANOP_WINDOWS
+	if (m_mapped) munmap(const_cast<uint8_t*>(mp_data), m_size);
+#endif
+}
+
+LIBANOP_FUNC_CODEPT void c_InputReplay::setWindowID(uint32_t windowID) noexcept {
+	m_windowID = windowID;
+}
+
+LIBANOP_FUNC_CODEPT void c_InputReplay::restart() noexcept {
+	m_offset = sizeof(anoptamin_inputmagic) + sizeof(uint16_t);
+	m_startNanos = 0;
+	m_polls = 0;
+	m_events = 0;
+}
+
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const bool c_InputReplay::finished() const noexcept {
+	return m_offset >= m_size;
+}
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const size_t c_InputReplay::getPollsPlayed() const noexcept {
+	return m_polls;
+}
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const size_t c_InputReplay::getEventsPlayed() const noexcept {
+	return m_events;
+}
+
+LIBANOP_FUNC_CODEPT void c_InputReplay::pushPoll() {
+	uint32_t Count;
+	check_loaded( m_offset + sizeof(uint64_t) + sizeof(Count) <= m_size );
+	std::memcpy(&Count, mp_data + m_offset + sizeof(uint64_t), sizeof(Count));
+	m_offset += sizeof(uint64_t) + sizeof(Count);
+	for (uint32_t i = 0; i < Count; i++) {
+		uint16_t Length;
+		check_loaded( m_offset + sizeof(Length) <= m_size );
+		std::memcpy(&Length, mp_data + m_offset, sizeof(Length));
+		m_offset += sizeof(Length);
+		check_loaded( Length <= sizeof(SDL_Event) && m_offset + Length <= m_size );
+		
+		SDL_Event E;
+		std::memset(&E, 0, sizeof(E));
+		std::memcpy(&E, mp_data + m_offset, Length);
+		m_offset += Length;
+		if (m_windowID != 0) {
+			switch (E.type) {
+				case SDL_KEYDOWN: case SDL_KEYUP: E.key.windowID = m_windowID; break;
+				case SDL_MOUSEMOTION: E.motion.windowID = m_windowID; break;
+				case SDL_MOUSEBUTTONDOWN: case SDL_MOUSEBUTTONUP: E.button.windowID = m_windowID; break;
+				case SDL_MOUSEWHEEL: E.wheel.windowID = m_windowID; break;
+				case SDL_WINDOWEVENT: E.window.windowID = m_windowID; break;
+				default: break;
+			};
+		}
+		assert_libsdl( SDL_PushEvent(&E) >= 0 );
+	}
+	m_polls++;
+	m_events += Count;
+}
+
+LIBANOP_FUNC_CODEPT size_t c_InputReplay::pump() {
+	const size_t Before = m_events;
+	if (m_speed == 0.0) {
+		if (!this->finished()) this->pushPoll();
+		return m_events - Before;
+	}
+	const uint64_t Now = clockNanos();
+	if (m_startNanos == 0) m_startNanos = Now;
+	const double Elapsed = double(Now - m_startNanos) * m_speed;
+	while (!this->finished()) {
+		uint64_t Due;
+		check_loaded( m_offset + sizeof(Due) <= m_size );
+		std::memcpy(&Due, mp_data + m_offset, sizeof(Due));
+		if (double(Due) > Elapsed) break;
+		this->pushPoll();
+	}
+	return m_events - Before;
+}
+
+LIBANOP_FUNC_CODEPT void c_InputReplay::useDummyVideoDriver() {
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+}
+
+LIBANOP_FUNC_CODEPT std::vector<SDL_Event> c_SDLWindow::fullEventPoll() {
+	const c_SDLEventView Polled = this->pollEvents();
+	return std::vector<SDL_Event>(Polled.begin(), Polled.end());
+}
+
+LIBANOP_FUNC_CODEPT void c_SDLWindow::deferKeyboardEvent(const SDL_Event& event) {
+	this->m_hookKeyboard.Defer<SDL_Event>(event);
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::deferMouseButtonEvent(const SDL_Event& event) {
+	this->m_hookMouseBtn.Defer<SDL_Event>(event);
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::deferMouseMotionEvent(const SDL_Event& event) {
+	this->m_hookMouseMove.Defer<SDL_Event>(event);
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::deferMouseScrollEvent(const SDL_Event& event) {
+	this->m_hookMouseScrl.Defer<SDL_Event>(event);
+}
+
 //! Hides the window.
 LIBANOP_FUNC_CODEPT void c_SDLWindow::hideWindow() {
 	if (this->m_hidden) return;
@@ -357,8 +1142,189 @@ LIBANOP_FUNC_CODEPT void c_SDLWindow::restoreFromMinMax() {
 LIBANOP_FUNC_CODEPT void c_SDLWindow::refreshWindowSurface() {
 	assert_safety( this->m_open );
 	
-	SDL_UpdateWindowSurface( this->mp_window );
-	
+	if (!this->m_backbuffer.empty()) this->showFrame(this->m_backView);
+	this->pushSurface();
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::showFrame(const Graphics::c_PixelView& frame) {
+	const bool Lock = SDL_MUSTLOCK(this->mp_baseSurf);
+	if (Lock) assert_libsdl( SDL_LockSurface(this->mp_baseSurf) == 0 );
+	const Graphics::c_PixelView Surface = Graphics::c_PixelView::of(this->mp_baseSurf);
+	if (frame.Width == Surface.Width && frame.Height == Surface.Height) {
+		Graphics::blit(frame, NULL, Surface, 0, 0);
+	} else {
+		Graphics::scale(frame, Surface, this->m_scaleFilter);
+	}
+	if (Lock) SDL_UnlockSurface(this->mp_baseSurf);
+	this->m_dirty.addAll();
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::pushSurface() {
+	const Graphics::c_DirtyRegion& Dirty = this->m_dirty;
+	if (!this->m_dirtyTracking || Dirty.full() || Dirty.getCoverage() >= this->m_dirtyFullCoverage) {
+		SDL_UpdateWindowSurface( this->mp_window );
+		this->m_presentStats.Full++;
+		this->m_presentStats.Pixels += uint64_t(this->mp_baseSurf->w) * uint64_t(this->mp_baseSurf->h);
+	} else if (Dirty.empty()) {
+		this->m_presentStats.Skipped++;
+	} else {
+		const std::vector<SDL_Rect>& Rects = Dirty.getRects();
+		SDL_UpdateWindowSurfaceRects( this->mp_window, Rects.data(), int(Rects.size()) );
+		this->m_presentStats.Partial++;
+		this->m_presentStats.Pixels += Dirty.getArea();
+	}
+	this->m_dirty.clear();
+	this->markPresented();
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::setDirtyTracking(bool enabled) {
+	this->m_dirtyTracking = enabled;
+	this->m_dirty.addAll(); // Whatever was drawn before is not known to be on screen.
+}
+LIBANOP_FUNC_CODEPT bool c_SDLWindow::getDirtyTracking() const noexcept {
+	return this->m_dirtyTracking;
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::setDirtyThresholds(uint32_t mergeCost, float fullCoverage) {
+	check_param( fullCoverage > 0 && fullCoverage <= 1 );
+	this->m_dirty.setMergeCost(mergeCost);
+	this->m_dirtyFullCoverage = fullCoverage;
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::markDirty(const SDL_Rect& rect) {
+	this->m_dirty.add(rect);
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::markAllDirty() {
+	this->m_dirty.addAll();
+}
+LIBANOP_FUNC_CODEPT const Graphics::c_DirtyRegion& c_SDLWindow::getDirtyRegion() const noexcept {
+	return this->m_dirty;
+}
+LIBANOP_FUNC_CODEPT c_SDLPresentStats c_SDLWindow::getPresentStats() const noexcept {
+	return this->m_presentStats;
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::resetPresentStats() noexcept {
+	this->m_presentStats = c_SDLPresentStats();
+}
+//! Draws onto the surface
+LIBANOP_FUNC_CODEPT void c_SDLWindow::drawRect(const SDL_Rect* rect, uint32_t color) {
+	const SDL_Rect Area = (rect == NULL) ? this->m_dirty.getBounds() : *rect;
+	this->drawTo(Area, [&](const Graphics::c_PixelView& dst) { Graphics::fillRect(dst, &Area, color); });
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::drawClear(uint32_t color) {
+	this->drawRect(NULL, color);
+}
+//! Gets the part of the surface a blit of 'srcRect' of 'src' to x, y lands on, before clipping to the surface.
+static SDL_Rect BlitArea(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y) {
+	const SDL_Rect From = (srcRect == NULL) ? src.bounds() : *srcRect;
+	return {x, y, From.w, From.h};
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::drawBlit(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y) {
+	this->drawTo(BlitArea(src, srcRect, x, y), [&](const Graphics::c_PixelView& dst) { Graphics::blit(src, srcRect, dst, x, y); });
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::drawBlitKeyed(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y, uint32_t key) {
+	this->drawTo(BlitArea(src, srcRect, x, y), [&](const Graphics::c_PixelView& dst) { Graphics::blitKeyed(src, srcRect, dst, x, y, key); });
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::drawBlitBlended(const Graphics::c_PixelView& src, const SDL_Rect* srcRect, int32_t x, int32_t y) {
+	this->drawTo(BlitArea(src, srcRect, x, y), [&](const Graphics::c_PixelView& dst) { Graphics::blitBlended(src, srcRect, dst, x, y); });
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::drawTiled(Graphics::c_TiledRenderer& renderer) {
+	assert_safety( this->m_open );
+	if (!this->m_backbuffer.empty()) {
+		renderer.flush(this->m_backView);
+		return;
+	}
+	const bool Lock = SDL_MUSTLOCK(this->mp_baseSurf);
+	if (Lock) assert_libsdl( SDL_LockSurface(this->mp_baseSurf) == 0 );
+	renderer.flush(Graphics::c_PixelView::of(this->mp_baseSurf), &this->m_dirty);
+	if (Lock) SDL_UnlockSurface(this->mp_baseSurf);
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::fitBackbuffer() {
+	if (this->m_renderScale >= 1) {
+		std::vector<uint32_t>().swap(this->m_backbuffer);
+		this->m_backView = Graphics::c_PixelView();
+	} else {
+		const int32_t Width = std::max(1, int32_t(std::lround(this->mp_baseSurf->w * this->m_renderScale)));
+		const int32_t Height = std::max(1, int32_t(std::lround(this->mp_baseSurf->h * this->m_renderScale)));
+		if (Width != this->m_backView.Width || Height != this->m_backView.Height) {
+			this->m_backbuffer.assign(size_t(Width) * size_t(Height), 0);
+			this->m_backView = {this->m_backbuffer.data(), Width, Height, Width};
+		}
+	}
+	if (this->mp_render) this->mp_render->Size.store((uint32_t(this->getRenderWidth()) << 16) | uint32_t(this->getRenderHeight()));
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::setRenderScale(float scale, Graphics::e_Scale_Filter filter) {
+	assert_safety( this->m_open );
+	check_param( scale > 0 && scale <= 1 );
+	this->m_renderScale = scale;
+	this->m_scaleFilter = filter;
+	this->fitBackbuffer();
+}
+LIBANOP_FUNC_CODEPT float c_SDLWindow::getRenderScale() const noexcept {
+	return this->m_renderScale;
+}
+LIBANOP_FUNC_CODEPT Graphics::e_Scale_Filter c_SDLWindow::getScaleFilter() const noexcept {
+	return this->m_scaleFilter;
+}
+LIBANOP_FUNC_CODEPT int32_t c_SDLWindow::getRenderWidth() const noexcept {
+	return this->m_backbuffer.empty() ? this->mp_baseSurf->w : this->m_backView.Width;
+}
+LIBANOP_FUNC_CODEPT int32_t c_SDLWindow::getRenderHeight() const noexcept {
+	return this->m_backbuffer.empty() ? this->mp_baseSurf->h : this->m_backView.Height;
+}
+LIBANOP_FUNC_CODEPT Graphics::c_PixelView c_SDLWindow::getRenderTarget() {
+	assert_safety( this->m_open );
+	return this->m_backbuffer.empty() ? Graphics::c_PixelView::of(this->mp_baseSurf) : this->m_backView;
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::startRenderThread(t_RenderThreadFunc render, uint8_t buffers) {
+	assert_safety( this->m_open );
+	check_param( render && (buffers == 2 || buffers == 3) );
+	this->stopRenderThread();
+	this->mp_render.reset(new c_RenderThread());
+	c_RenderThread& R = *this->mp_render;
+	R.Render = std::move(render);
+	R.Buffers = buffers;
+	R.Size.store((uint32_t(this->getRenderWidth()) << 16) | uint32_t(this->getRenderHeight()));
+	for (uint8_t i = 0; i < buffers; i++) R.fit(i);
+	R.Thread = std::thread(&c_RenderThread::loop, &R);
+	Anoptamin_LogDebug("Started a render thread with " + std::to_string(buffers) + " buffers for window ID #" + std::to_string(this->m_windowID));
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::stopRenderThread() {
+	if (!this->mp_render) return;
+	this->mp_render->Running.store(0, std::memory_order_release);
+	if (this->mp_render->Thread.joinable()) this->mp_render->Thread.join();
+}
+LIBANOP_FUNC_CODEPT bool c_SDLWindow::isRenderThreadRunning() const noexcept {
+	return this->mp_render && this->mp_render->Running.load(std::memory_order_acquire);
+}
+LIBANOP_FUNC_CODEPT bool c_SDLWindow::presentRendered() {
+	assert_safety( this->m_open );
+	check_thread( this->mp_render != nullptr );
+	c_RenderThread& R = *this->mp_render;
+	const uint8_t Shared = R.Handoff.load(std::memory_order_acquire);
+	if (!(Shared & c_RenderThread::Fresh)) {
+		R.Stale.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	uint8_t Shown = Shared & c_RenderThread::Mask;
+	if (R.Buffers == 3) {
+		Shown = R.Handoff.exchange(R.Front, std::memory_order_acq_rel) & c_RenderThread::Mask;
+		R.Front = Shown;
+	}
+	R.FrameAge.record(clockNanos() - R.FinishedAt[Shown]);
+	this->showFrame(R.Views[Shown]);
+	if (R.Buffers == 2) R.Handoff.store(Shown, std::memory_order_release);
+	R.Presented.fetch_add(1, std::memory_order_relaxed);
+	this->pushSurface();
+	return true;
+}
+LIBANOP_FUNC_CODEPT c_SDLRenderStats c_SDLWindow::getRenderStats() const {
+	c_SDLRenderStats Out;
+	if (!this->mp_render) return Out;
+	const c_RenderThread& R = *this->mp_render;
+	Out.Rendered = R.Rendered.load(std::memory_order_relaxed);
+	Out.Presented = R.Presented.load(std::memory_order_relaxed);
+	Out.Dropped = R.Dropped.load(std::memory_order_relaxed);
+	Out.Stale = R.Stale.load(std::memory_order_relaxed);
+	Out.RenderTime = R.RenderTime.getSummary();
+	Out.FrameAge = R.FrameAge.getSummary();
+	Out.LastRenderNanos = R.LastRender.load(std::memory_order_relaxed);
+	return Out;
 }
 //! Grab the mouse
 LIBANOP_FUNC_CODEPT void c_SDLWindow::grabMouseFocus() {
@@ -383,6 +1349,9 @@ LIBANOP_FUNC_CODEPT void c_SDLWindow::releaseInputFocus() {
 	
 }
 
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const uint32_t c_SDLWindow::getWindowID() const noexcept {
+	return this->m_windowID;
+}
 LIBANOP_FUNC_CODEPT SDL_Window* c_SDLWindow::getRawSDLWindow() {
 	return this->mp_window;
 }
@@ -408,38 +1377,11 @@ LIBANOP_FUNC_CODEPT void c_SDLWindow::flashWindowToFocus() {
 
 //! Gets the most recent key presses from the last eventPollSelf() call.
 LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT std::vector<SDL_Scancode> c_SDLWindow::getLastKeys() {
-	
-	const uint8_t* Keystates = SDL_GetKeyboardState( NULL );
-	assert_libsdl( Keystates != NULL );
-	
 	std::vector<SDL_Scancode> output;
-	
-	// Use the standard keyboard layout + basic numpad
-	SDL_Scancode ix = SDL_SCANCODE_A;
-	int* ip = (int*)(&ix); // this is disgusting, yes, but SDL defines the scancodes as a typedef enum and you can't iterate thru it normally
-	for (; ix <= SDL_SCANCODE_KP_PERIOD; (*ip)++) {
-		if (Keystates[ix]) {
-			output.push_back(ix);
-		}
-	}
-	// Get the Left/Right control, shift, alt, etc. keys
-	ix = SDL_SCANCODE_LCTRL;
-	for (; ix <= SDL_SCANCODE_RGUI; (*ip)++) {
-		if (Keystates[ix]) {
-			output.push_back(ix);
-		}
-	}
-	
+	output.reserve(this->m_keysNow.count());
+	for (SDL_Scancode X : this->m_keysNow) output.push_back(X);
 	return output;
 }
-//! Tests if a given key is pressed in last poll.
-LIBANOP_FUNC_CODEPT LIBANOP_FUNC_HOT bool c_SDLWindow::keyPressed(SDL_Scancode what) {
-	
-	const uint8_t* Keystates = SDL_GetKeyboardState( NULL );
-	assert_libsdl( Keystates != NULL );
-	
-	return (Keystates[what] != 0);
-}
 
 
 //! Hooks a function for its Keyboard Event hook.
@@ -463,6 +1405,30 @@ LIBANOP_FUNC_CODEPT uint16_t c_SDLWindow::addHook_MouseScrollEvent(const c_Hooka
 	return this->m_hookMouseScrl.HookFunction(function);
 }
 
+//! Hooks a function for its Raw Mouse Motion Event hook, which ignores coalescing.
+LIBANOP_FUNC_CODEPT uint16_t c_SDLWindow::addHook_MouseMotionRawEvent(const c_Hookable_Func& function) {
+	return this->m_hookMouseMoveRaw.HookFunction(function);
+}
+LIBANOP_FUNC_CODEPT void c_SDLWindow::setMouseMotionCoalescing(bool coalesce) noexcept {
+	this->m_coalesceMotion = coalesce;
+}
+LIBANOP_FUNC_CODEPT LIBANOP_FUNC_FIX_STATE const bool c_SDLWindow::getMouseMotionCoalescing() const noexcept {
+	return this->m_coalesceMotion;
+}
+
+LIBANOP_FUNC_CODEPT uint16_t c_SDLWindow::addHook_KeyboardEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter) {
+	return this->m_routeKeyboard.add(function, filter, this->m_hookKeyboard.Name + " (Filtered)");
+}
+LIBANOP_FUNC_CODEPT uint16_t c_SDLWindow::addHook_MouseButtonEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter) {
+	return this->m_routeMouseBtn.add(function, filter, this->m_hookMouseBtn.Name + " (Filtered)");
+}
+LIBANOP_FUNC_CODEPT uint16_t c_SDLWindow::addHook_MouseMotionEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter) {
+	return this->m_routeMouseMove.add(function, filter, this->m_hookMouseMove.Name + " (Filtered)");
+}
+LIBANOP_FUNC_CODEPT uint16_t c_SDLWindow::addHook_MouseScrollEvent(const c_Hookable_Func& function, const c_SDLEventFilter& filter) {
+	return this->m_routeMouseScrl.add(function, filter, this->m_hookMouseScrl.Name + " (Filtered)");
+}
+
 LIBANOP_FUNC_CODEPT const bool c_SDLWindow::isOpen() const noexcept {
 	return this->m_open;
 }
@@ -1,5 +1,6 @@
 #include "include/base.hpp"
 #include "include/sdl.hpp"
+#include "include/frame.hpp"
 
 
 Anoptamin::Base::c_SDLWindow* BobWindow;
@@ -9,20 +10,15 @@ Anoptamin::Base::c_HookReturn exitWindowOnEsc(size_t inputVectorSize, uint16_t i
 	check_ptr( EventList != NULL );
 
 	Anoptamin::Base::c_HookReturn TopTMP;
-	std::clock_t StartTicks = std::clock();
 	TopTMP.Valid = 1;
 
 	Anoptamin_LogDebug("Running Hooked Function!");
 
-	for (size_t i = 0; i < inputVectorSize; i++) {
-		const SDL_Event X = EventList[i];
-		if (X.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
-			Anoptamin_LogDebug("MWAAHAHAHAHAHAHAH!!!!");
-			BobWindow->closeWindow(); break;
-		}
+	// Hooked with a filter, so only presses of the ESC key ever get here.
+	if (inputVectorSize != 0) {
+		Anoptamin_LogDebug("MWAAHAHAHAHAHAHAH!!!!");
+		BobWindow->closeWindow();
 	}
-	std::clock_t EndTicks = std::clock();
-	TopTMP.ElapsedTicks = EndTicks - StartTicks;
 	return TopTMP;
 }
 
@@ -38,18 +34,19 @@ int main() {
 		"Test Window for The Doom Test", false, Anoptamin::Base::TYPE_GENERIC, true, true);
 	Anoptamin_LogCommon("Window Created.");
 	
-	BobWindow->addHook_KeyboardEvent(exitWindowOnEsc_F);
+	BobWindow->addHook_KeyboardEvent(exitWindowOnEsc_F,
+		Anoptamin::Base::c_SDLEventFilter::keys({SDL_SCANCODE_ESCAPE}, Anoptamin::Base::SUBTYPE_PRESS));
 	
-	bool isclosed = 0;
-	for (uint16_t i = 0; i < 5000; i++) {
-		std::vector<SDL_Event> Events = BobWindow->fullEventPoll();
-		// Wait one millisecond
-		SDL_Delay(1);
-		if (!BobWindow->isOpen()) {
-			isclosed = 1;
-			break;
-		}
-	}
+	// Run for about five seconds at the display's refresh rate. Frames of a hidden window can wait far longer than a
+	// refresh, so the run is bounded by time rather than by a count of frames.
+	BobWindow->setInputTracing(true);
+	Anoptamin::Base::c_FrameScheduler Loop(BobWindow);
+	Loop.syncToDisplay();
+	const uint64_t Deadline = Anoptamin::Base::clockNanos() + 5000000000ull;
+	while (Anoptamin::Base::clockNanos() < Deadline && Loop.frame()) {}
+	Loop.logTimingReport();
+	BobWindow->logInputLatencyReport();
+	const bool isclosed = !BobWindow->isOpen();
 
 	if (!isclosed) BobWindow->closeWindow(); else {
 		Anoptamin_LogCommon("Window Closed at User Bequest.");
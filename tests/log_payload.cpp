@@ -0,0 +1,83 @@
+/********!
+ * @file  log_payload.cpp
+ *
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ *
+ * @date
+ * 	16 October 2026
+ *
+ * @brief
+ * 	Checks that binary log records never pack past their payload, and
+ *	that strings cut short to fit are marked as truncated when they
+ *	are rendered. Exits non-zero if anything fails.
+ *
+ * @note
+ *	Run from a directory where a 'logs' folder may be created.
+ *
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ *
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ *
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ********/
+
+#include "../include/base.hpp"
+
+using Anoptamin::Log::LogMaxPayload;
+
+static uint32_t Failures = 0;
+
+static void expect(bool passed, const std::string& what) {
+	if (passed) return;
+	std::cerr << "FAILED: " << what << '\n';
+	Failures++;
+}
+
+//! Packs a string which nearly fills a record's payload, then another string, and checks that nothing is written or
+//! claimed past the payload, and that the render says so whenever either string did not fit.
+static void checkNearLimit(size_t length) {
+	uint8_t Data[LogMaxPayload + 16];
+	std::memset(Data, 0xA5, sizeof(Data));
+	size_t Pos = 0;
+	const std::string Long(length, 'x');
+	Anoptamin::Log::LogArgPack(Data, Pos, Long);
+	Anoptamin::Log::LogArgPack(Data, Pos, "and then some");
+
+	bool Guarded = 1;
+	for (size_t i = LogMaxPayload; i < sizeof(Data); i++) Guarded = Guarded && (Data[i] == 0xA5);
+	const std::string Name = "a " + std::to_string(length) + " byte string and another";
+	expect(Guarded && Pos <= LogMaxPayload, Name + " pack within the payload");
+
+	static const uint8_t Codes[2] = {Anoptamin::Log::LOGARG_STRING, Anoptamin::Log::LOGARG_STRING};
+	const std::string Rendered = Anoptamin::Log::RenderBinaryRecord("{} {}", Codes, 2, Data, uint16_t(Pos));
+	const bool Fits = (length + 2 + 2 + 13 <= LogMaxPayload);
+	expect(Fits == (Rendered == Long + " and then some"), Name + " render whole only if they fit");
+	expect(Fits == (Rendered.find("[truncated]") == std::string::npos), Name + " are marked when cut short");
+}
+
+int main() {
+	Anoptamin::Log::SetupFiles();
+
+	for (size_t Length = LogMaxPayload - 24; Length <= LogMaxPayload + 2; Length++) checkNearLimit(Length);
+
+	// The same through the real path, which packs onto the stack.
+	Anoptamin::Log::EnableBinaryLogging();
+	Anoptamin_LogDebugF("Long {} then {}", std::string(LogMaxPayload - 3, 'x'), "more");
+	Anoptamin::Log::Log(Anoptamin::Log::LOG_DEBUG, std::string(LogMaxPayload * 2, 'y'));
+	Anoptamin::Log::DisableBinaryLogging();
+
+	Anoptamin::Log::CleanupFiles();
+	std::cout << (Failures == 0 ? "All log payload checks passed.\n" : "Some log payload checks failed.\n");
+	return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/********!
+ * @file  alog_decode.cpp
+ *
+ * @author
+ * 	Evan Clegern <evanclegern.work@gmail.com>
+ *
+ * @date
+ * 	16 October 2026
+ *
+ * @brief
+ * 	Offline decoder for the binary '.alog' files written once
+ *	Anoptamin::Log::EnableBinaryLogging() is called. Turns them back
+ *	into the same layout as the text logs.
+ *
+ * @note
+ *	Usage: alog_decode <file.alog> [output.log]
+ *	Without an output path, the text goes to stdout.
+ *
+ * @copyright
+ * 	Copyright (C) 2023 Evan Clegern
+ *
+ * 	This program is free software: you can redistribute it and/or modify
+ * 	it under the terms of the GNU General Public License, as published by
+ * 	the Free Software Foundation, version 3 of the License.
+ *
+ * 	This program is distributed in the hope that it will be useful,
+ * 	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * 	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * 	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License
+ * 	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ ********/
+
+#include "../include/base.hpp"
+
+#include <unordered_map>
+
+//! A call site as described by the binary log.
+struct c_Descriptor {
+	Anoptamin::Log::e_LogSeverity Severity;
+	std::vector<uint8_t> Codes;
+	std::string Format;
+};
+
+template<typename T> bool readRaw(std::ifstream& in, T& out) {
+	return bool(in.read((char*)&out, sizeof(T)));
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <file.alog> [output.log]\n";
+		return 1;
+	}
+	std::ifstream in(argv[1], std::ios::binary);
+	if (!in.is_open()) {
+		std::cerr << "Could not open '" << argv[1] << "'.\n";
+		return 1;
+	}
+	std::ofstream outFile;
+	if (argc > 2) {
+		outFile.open(argv[2], std::ios::trunc);
+		if (!outFile.is_open()) {
+			std::cerr << "Could not open '" << argv[2] << "'.\n";
+			return 1;
+		}
+	}
+	std::ostream& out = (argc > 2) ? outFile : std::cout;
+
+	char Magic[8]; uint16_t Version, DateLen; uint64_t Start;
+	if (!in.read(Magic, 8) || std::memcmp(Magic, "ANOPALOG", 8) != 0 || !readRaw(in, Version) || Version != 1) {
+		std::cerr << "'" << argv[1] << "' is not a version 1 Anoptamin binary log.\n";
+		return 1;
+	}
+	readRaw(in, Start); readRaw(in, DateLen);
+	std::string Date(DateLen, '\0');
+	in.read(&Date[0], DateLen);
+	out << "ANOPTAMIN Log Created on " << Date << " (Start " << Start << "us after the Unix epoch).\n";
+
+	std::unordered_map<uint32_t, c_Descriptor> Descriptors;
+	std::string Line;
+	uint8_t Payload[65536];
+	uint64_t Records = 0;
+
+	uint8_t Tag;
+	while (readRaw(in, Tag)) {
+		uint32_t ID;
+		if (!readRaw(in, ID)) break;
+		if (Tag == 1) {
+			c_Descriptor D; uint8_t Sev, Argc; uint16_t FmtLen;
+			if (!readRaw(in, Sev) || !readRaw(in, Argc)) break;
+			D.Severity = Anoptamin::Log::e_LogSeverity(Sev);
+			D.Codes.resize(Argc);
+			if (Argc != 0 && !in.read((char*)D.Codes.data(), Argc)) break;
+			if (!readRaw(in, FmtLen)) break;
+			D.Format.resize(FmtLen);
+			if (FmtLen != 0 && !in.read(&D.Format[0], FmtLen)) break;
+			Descriptors[ID] = std::move(D);
+		} else if (Tag == 2) {
+			uint64_t Ticks; uint16_t Len;
+			if (!readRaw(in, Ticks) || !readRaw(in, Len)) break;
+			if (Len != 0 && !in.read((char*)Payload, Len)) break;
+
+			auto Found = Descriptors.find(ID);
+			Line.clear();
+			if (Found == Descriptors.end()) {
+				Anoptamin::Log::FormatLogLine(Line, Anoptamin::Log::LOG_WARN, Ticks, "Record with unknown descriptor #" + std::to_string(ID));
+			} else {
+				const c_Descriptor& D = Found->second;
+				Anoptamin::Log::FormatLogLine(Line, D.Severity, Ticks,
+					Anoptamin::Log::RenderBinaryRecord(D.Format.c_str(), D.Codes.data(), uint8_t(D.Codes.size()), Payload, Len));
+			}
+			out << Line;
+			Records++;
+		} else {
+			std::cerr << "Corrupt record tag " << unsigned(Tag) << " after " << Records << " records.\n";
+			return 2;
+		}
+	}
+	out << std::flush;
+	std::cerr << "Decoded " << Records << " records with " << Descriptors.size() << " call sites.\n";
+	return 0;
+}